@@ -0,0 +1,128 @@
+#include "bus.h"
+#include "impl/bus_impl.h"
+#include "impl/source_impl.h"
+
+namespace audio
+{
+bus::bus()
+    : impl_(std::make_unique<detail::bus_impl>())
+{
+}
+
+bus::~bus() = default;
+
+bus::bus(bus&& rhs) noexcept = default;
+
+bus& bus::operator=(bus&& rhs) noexcept = default;
+
+auto bus::set_parent(bus& parent) -> bool
+{
+    if(impl_ && parent.impl_)
+    {
+        return impl_->set_parent(parent.impl_.get());
+    }
+    return false;
+}
+
+void bus::clear_parent()
+{
+    if(impl_)
+    {
+        impl_->set_parent(nullptr);
+    }
+}
+
+void bus::add(source& src)
+{
+    if(impl_ && src.impl_)
+    {
+        impl_->add(src.impl_.get());
+    }
+}
+
+void bus::remove(source& src)
+{
+    if(impl_ && src.impl_)
+    {
+        impl_->remove(src.impl_.get());
+    }
+}
+
+auto bus::get_source_count() const -> size_t
+{
+    return impl_ ? impl_->get_source_count() : 0;
+}
+
+void bus::set_volume(float volume)
+{
+    if(impl_)
+    {
+        impl_->set_volume(volume);
+    }
+}
+
+auto bus::get_volume() const -> float
+{
+    return impl_ ? impl_->get_volume() : 0.f;
+}
+
+void bus::set_pitch(float pitch)
+{
+    if(impl_)
+    {
+        impl_->set_pitch(pitch);
+    }
+}
+
+auto bus::get_pitch() const -> float
+{
+    return impl_ ? impl_->get_pitch() : 0.f;
+}
+
+void bus::mute()
+{
+    if(impl_)
+    {
+        impl_->mute();
+    }
+}
+
+void bus::unmute()
+{
+    if(impl_)
+    {
+        impl_->unmute();
+    }
+}
+
+auto bus::is_muted() const -> bool
+{
+    return impl_ ? impl_->is_muted() : false;
+}
+
+void bus::pause()
+{
+    if(impl_)
+    {
+        impl_->pause();
+    }
+}
+
+void bus::resume()
+{
+    if(impl_)
+    {
+        impl_->resume();
+    }
+}
+
+auto bus::is_paused() const -> bool
+{
+    return impl_ ? impl_->is_paused() : false;
+}
+
+void bus::flush()
+{
+    detail::bus_impl::flush_dirty();
+}
+} // namespace audio
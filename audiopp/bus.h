@@ -0,0 +1,123 @@
+#pragma once
+
+#include "source.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace audio
+{
+namespace detail
+{
+class bus_impl;
+}
+
+//-----------------------------------------------------------------------------
+/// Group of sources controlled together, e.g. the music, the ambience or the
+/// whole world. Buses can be nested, the volume and the pitch of a bus scale
+/// those of its sources and of the buses under it, pausing or muting a bus
+/// pauses or mutes them too. A source is in one bus at most.
+//-----------------------------------------------------------------------------
+class bus
+{
+public:
+    bus();
+    ~bus();
+    bus(bus&& rhs) noexcept;
+    bus& operator=(bus&& rhs) noexcept;
+
+    bus(const bus& rhs) = delete;
+    bus& operator=(const bus& rhs) = delete;
+
+    //-----------------------------------------------------------------------------
+    /// Puts this bus under another one. Fails if the parent is this bus or
+    /// one of the buses under it.
+    //-----------------------------------------------------------------------------
+    auto set_parent(bus& parent) -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Makes this bus a top level one.
+    //-----------------------------------------------------------------------------
+    void clear_parent();
+
+    //-----------------------------------------------------------------------------
+    /// Adds the source to this bus, taking it out of the one it was in.
+    //-----------------------------------------------------------------------------
+    void add(source& src);
+
+    //-----------------------------------------------------------------------------
+    /// Takes the source out of this bus.
+    //-----------------------------------------------------------------------------
+    void remove(source& src);
+
+    //-----------------------------------------------------------------------------
+    /// Gets how many sources are in this bus, not counting the buses under it.
+    //-----------------------------------------------------------------------------
+    auto get_source_count() const -> size_t;
+
+    //-----------------------------------------------------------------------------
+    /// Scales the volume of the sources. The change reaches the sources
+    /// with the next system::update.
+    //-----------------------------------------------------------------------------
+    void set_volume(float volume);
+
+    //-----------------------------------------------------------------------------
+    /// Gets the volume of this bus alone.
+    //-----------------------------------------------------------------------------
+    auto get_volume() const -> float;
+
+    //-----------------------------------------------------------------------------
+    /// Scales the pitch of the sources. The change reaches the sources
+    /// with the next system::update.
+    //-----------------------------------------------------------------------------
+    void set_pitch(float pitch);
+
+    //-----------------------------------------------------------------------------
+    /// Gets the pitch of this bus alone.
+    //-----------------------------------------------------------------------------
+    auto get_pitch() const -> float;
+
+    //-----------------------------------------------------------------------------
+    /// Silences the sources, keeping the volume. The change reaches the
+    /// sources with the next system::update.
+    //-----------------------------------------------------------------------------
+    void mute();
+
+    //-----------------------------------------------------------------------------
+    /// Restores the volume of the sources.
+    //-----------------------------------------------------------------------------
+    void unmute();
+
+    //-----------------------------------------------------------------------------
+    /// Checks whether this bus itself is muted.
+    //-----------------------------------------------------------------------------
+    auto is_muted() const -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Pauses the playing sources right away, all of them with a single call
+    /// into OpenAL. The effects bound to them are not asked first.
+    //-----------------------------------------------------------------------------
+    void pause();
+
+    //-----------------------------------------------------------------------------
+    /// Resumes the sources paused by this bus, unless a parent is paused too.
+    /// Sources paused on their own stay paused.
+    //-----------------------------------------------------------------------------
+    void resume();
+
+    //-----------------------------------------------------------------------------
+    /// Checks whether this bus or one of its parents is paused.
+    //-----------------------------------------------------------------------------
+    auto is_paused() const -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Applies the changed volumes and pitches of all the buses to their
+    /// sources. system::update does so each frame.
+    //-----------------------------------------------------------------------------
+    static void flush();
+
+private:
+    /// pimpl idiom
+    std::unique_ptr<detail::bus_impl> impl_;
+};
+} // namespace audio
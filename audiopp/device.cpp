@@ -37,6 +37,22 @@ void device::disable()
     }
 }
 
+void device::begin_update()
+{
+    if(impl_)
+    {
+        impl_->begin_update();
+    }
+}
+
+void device::end_update()
+{
+    if(impl_)
+    {
+        impl_->end_update();
+    }
+}
+
 auto device::is_valid() const -> bool
 {
     return impl_ && impl_->is_valid();
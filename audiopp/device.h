@@ -36,6 +36,19 @@ public:
     //-----------------------------------------------------------------------------
     void disable();
 
+    //-----------------------------------------------------------------------------
+    /// Starts collecting the property changes of sources and the listener.
+    /// Nothing is applied until end_update, where only the changed properties
+    /// are flushed and committed at once, so that they take effect in the same
+    /// mix. Calls can be nested.
+    //-----------------------------------------------------------------------------
+    void begin_update();
+
+    //-----------------------------------------------------------------------------
+    /// Commits the property changes collected since begin_update.
+    //-----------------------------------------------------------------------------
+    void end_update();
+
     //-----------------------------------------------------------------------------
     /// Checks whether the device and context are valid.
     //-----------------------------------------------------------------------------
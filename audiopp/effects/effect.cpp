@@ -1,4 +1,5 @@
 #include "effect.h"
+#include "../impl/binding_registry.h"
 #include "../impl/source_impl.h"
 #include "../source.h"
 
@@ -16,7 +17,8 @@ effect& effect::operator=(effect&& rhs) noexcept
 {
     if(this != &rhs)
     {
-        bound_sources_visitor([this](source* src) { src->remove_dead_effect(this); });
+        unbind_all_sources();
+        detail::binding_registry::release_effect(binding_);
         move(std::move(rhs));
     }
     return *this;
@@ -24,13 +26,13 @@ effect& effect::operator=(effect&& rhs) noexcept
 
 effect::~effect()
 {
-    bound_sources_visitor([this](source* src) { src->remove_dead_effect(this); });
+    unbind_all_sources();
+    detail::binding_registry::release_effect(binding_);
 }
 
 auto effect::bind(source& src) noexcept -> bool
 {
-    auto it = bound_sources_.find(&src);
-    if(it != bound_sources_.end())
+    if(has_bound(src))
     {
         return true;
     }
@@ -40,43 +42,37 @@ auto effect::bind(source& src) noexcept -> bool
         return false;
     }
 
-    src.bind_effect(this);
-    assert(!is_iterating_bound_sources_);
-    bound_sources_.insert(&src);
+    detail::binding_registry::bind(src.binding_, &src, binding_, this);
+    src.effects_changed();
 
     return true;
 }
 
 void effect::unbind(source& src) noexcept
 {
-    auto it = bound_sources_.find(&src);
-    if(it != bound_sources_.end())
+    if(has_bound(src))
     {
         unbind_impl(src);
 
-        src.unbind_effect(this);
-        assert(!is_iterating_bound_sources_);
-        bound_sources_.erase(it);
+        detail::binding_registry::unbind(src.binding_, binding_);
+        src.effects_changed();
     }
 }
 
 void effect::unbind_all() noexcept
 {
     unbind_all_impl();
-
-    bound_sources_visitor([this](source* src) { src->unbind_effect(this); });
-    assert(!is_iterating_bound_sources_);
-    bound_sources_.clear();
+    unbind_all_sources();
 }
 
 auto effect::has_bound(const source& src) const noexcept -> bool
 {
-    return bound_sources_.find(&const_cast<source&>(src)) != bound_sources_.end();
+    return detail::binding_registry::is_bound(src.binding_, binding_);
 }
 
 auto effect::has_bound_source() const noexcept -> bool
 {
-    return !bound_sources_.empty();
+    return !detail::binding_registry::get_sources(binding_).empty();
 }
 
 void effect::update(source&, const duration_t&) noexcept
@@ -85,11 +81,10 @@ void effect::update(source&, const duration_t&) noexcept
 
 void effect::move(effect&& rhs) noexcept
 {
-    assert(!is_iterating_bound_sources_ && !rhs.is_iterating_bound_sources_);
-    bound_sources_ = std::move(rhs.bound_sources_);
-
-    bound_sources_visitor(
-        [ this, rhs_addr = &rhs ](source * src) { src->change_effect_address(rhs_addr, this); });
+    // the bindings refer to the slot, only the slot has to know the new address
+    binding_ = rhs.binding_;
+    rhs.binding_ = {};
+    detail::binding_registry::relocate(binding_, this);
 }
 
 void effect::request_play(source& src, const callback& ready_to_play) noexcept
@@ -143,39 +138,33 @@ void effect::force_stop(source&) noexcept
 void effect::remove_dead_source(source& src) noexcept
 {
     unbind_impl(src);
-    assert(bound_sources_.find(&src) != bound_sources_.end());
-    assert(!is_iterating_bound_sources_);
-    bound_sources_.erase(&src);
+    assert(has_bound(src));
+    detail::binding_registry::unbind(src.binding_, binding_);
 }
 
-void effect::change_source_address(source* from, source* to) noexcept
+void effect::unbind_all_sources() noexcept
 {
-    assert(from && to);
-    auto it = bound_sources_.find(from);
-    if(it != bound_sources_.end())
+    // unbinding swaps the last link into the freed position, so pop from the back.
+    // The list is fetched again each time, the callbacks may grow the registry.
+    while(!detail::binding_registry::get_sources(binding_).empty())
     {
-        assert(!is_iterating_bound_sources_);
-        bound_sources_.erase(it);
-        assert(bound_sources_.find(to) == bound_sources_.end());
-        bound_sources_.insert(to);
+        auto handle = detail::binding_registry::get_sources(binding_).back().other;
+        auto src = detail::binding_registry::get_source(handle);
+        detail::binding_registry::unbind(handle, binding_);
+        if(src)
+        {
+            src->effects_changed();
+        }
     }
-    change_source_address_impl(from, to);
 }
 
-void effect::change_source_address_impl(source*, source*) noexcept
+void effect::change_source_address(source* from, source* to) noexcept
 {
+    assert(from && to);
+    change_source_address_impl(from, to);
 }
 
-template <typename F>
-void effect::bound_sources_visitor(F&& func) noexcept(
-    noexcept(std::forward<F>(func)(std::declval<source*>())))
+void effect::change_source_address_impl(source*, source*) noexcept
 {
-    assert(!is_iterating_bound_sources_);
-    is_iterating_bound_sources_ = true;
-    for(auto& src : bound_sources_)
-    {
-        std::forward<F>(func)(src);
-    }
-    is_iterating_bound_sources_ = false;
 }
 }
@@ -1,7 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
-#include <unordered_set>
+#include <limits>
 
 #include "../types.h"
 
@@ -13,6 +14,16 @@ class source;
 namespace detail
 {
 class source_impl;
+
+//-----------------------------------------------------------------------------
+/// Slot of a source or an effect in the binding registry. The generation
+/// tells apart a slot reused after its object was destroyed.
+//-----------------------------------------------------------------------------
+struct binding_handle
+{
+    std::uint32_t index{std::numeric_limits<std::uint32_t>::max()};
+    std::uint32_t generation{};
+};
 }
 
 class effect
@@ -78,13 +89,11 @@ private:
     virtual void sound_changed(source& src) noexcept;
     virtual void force_stop(source& src) noexcept;
     void remove_dead_source(source& src) noexcept;
+    void unbind_all_sources() noexcept;
     void change_source_address(source* from, source* to) noexcept;
     virtual void change_source_address_impl(source*, source*) noexcept;
 
-    template <typename F>
-    void bound_sources_visitor(F&& func) noexcept(noexcept(std::forward<F>(func)(std::declval<source*>())));
-
-    std::unordered_set<source*> bound_sources_;
-    bool is_iterating_bound_sources_{};
+    /// the bound sources are kept in the binding registry
+    detail::binding_handle binding_;
 };
 }
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+
+namespace audio
+{
+
+//-----------------------------------------------------------------------------
+/// Filter on the direct path of a source, the one from the source to the
+/// listener, e.g. to muffle an occluded or obstructed source. Unlike the
+/// effects it takes up none of the auxiliary sends and costs next to nothing
+/// in the mixer. Needs the EFX extension, otherwise it is ignored.
+//-----------------------------------------------------------------------------
+struct filter
+{
+    enum class filter_type : std::uint8_t
+    {
+        none,
+        lowpass,
+        highpass,
+        bandpass
+    };
+
+    static auto lowpass(float gain, float gainhf) -> filter
+    {
+        return {filter_type::lowpass, gain, 1.0f, gainhf};
+    }
+
+    static auto highpass(float gain, float gainlf) -> filter
+    {
+        return {filter_type::highpass, gain, gainlf, 1.0f};
+    }
+
+    static auto bandpass(float gain, float gainlf, float gainhf) -> filter
+    {
+        return {filter_type::bandpass, gain, gainlf, gainhf};
+    }
+
+    filter_type type{filter_type::none};
+
+    /// gain of all the frequencies in range [0, 1]
+    float gain{1.0f};
+
+    /// gain of the low frequencies in range [0, 1], used by highpass and bandpass
+    float gainlf{1.0f};
+
+    /// gain of the high frequencies in range [0, 1], used by lowpass and bandpass
+    float gainhf{1.0f};
+};
+
+inline auto operator==(const filter& lhs, const filter& rhs) -> bool
+{
+    return lhs.type == rhs.type && lhs.gain == rhs.gain && lhs.gainlf == rhs.gainlf &&
+           lhs.gainhf == rhs.gainhf;
+}
+
+inline auto operator!=(const filter& lhs, const filter& rhs) -> bool
+{
+    return !(lhs == rhs);
+}
+} // namespace audio
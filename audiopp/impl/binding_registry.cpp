@@ -0,0 +1,232 @@
+#include "binding_registry.h"
+
+#include <cassert>
+#include <limits>
+
+namespace audio
+{
+namespace detail
+{
+namespace binding_registry
+{
+
+namespace
+{
+constexpr std::uint32_t invalid_index = std::numeric_limits<std::uint32_t>::max();
+
+template<typename T>
+struct slot_map
+{
+    struct slot
+    {
+        T* object{};
+        std::uint32_t generation{};
+        std::vector<link> links;
+    };
+
+    auto insert(T* object) -> binding_handle
+    {
+        std::uint32_t index = 0;
+        if(free.empty())
+        {
+            index = std::uint32_t(slots.size());
+            slots.emplace_back();
+        }
+        else
+        {
+            index = free.back();
+            free.pop_back();
+        }
+
+        auto& s = slots[index];
+        s.object = object;
+        return {index, s.generation};
+    }
+
+    void erase(binding_handle& handle)
+    {
+        auto s = find(handle);
+        if(!s)
+        {
+            return;
+        }
+
+        assert(s->links.empty());
+        s->object = nullptr;
+        s->links.clear();
+        // old handles to the slot go stale
+        s->generation++;
+        free.push_back(handle.index);
+        handle = {};
+    }
+
+    auto find(const binding_handle& handle) -> slot*
+    {
+        if(handle.index == invalid_index || handle.index >= slots.size())
+        {
+            return nullptr;
+        }
+
+        auto& s = slots[handle.index];
+        if(s.generation != handle.generation)
+        {
+            return nullptr;
+        }
+        return &s;
+    }
+
+    std::vector<slot> slots;
+    std::vector<std::uint32_t> free;
+};
+
+struct state
+{
+    slot_map<source> sources;
+    slot_map<effect> effects;
+};
+
+auto get_state() -> state&
+{
+    static state s;
+    return s;
+}
+
+auto no_links() -> const std::vector<link>&
+{
+    static const std::vector<link> empty;
+    return empty;
+}
+
+/// removes the link at the position and fixes up the reverse link of the one moved in its place
+template<typename T, typename U>
+void remove_link(slot_map<T>& map, const binding_handle& handle, std::uint32_t position, slot_map<U>& other_map)
+{
+    auto& links = map.find(handle)->links;
+    links[position] = links.back();
+    links.pop_back();
+
+    if(position < links.size())
+    {
+        const auto& moved = links[position];
+        other_map.find(moved.other)->links[moved.other_slot].other_slot = position;
+    }
+}
+
+auto find_link(const std::vector<link>& links, const binding_handle& other) -> std::uint32_t
+{
+    for(std::uint32_t i = 0; i < links.size(); ++i)
+    {
+        if(links[i].other.index == other.index && links[i].other.generation == other.generation)
+        {
+            return i;
+        }
+    }
+    return invalid_index;
+}
+} // namespace
+
+void bind(binding_handle& src_handle, source* src, binding_handle& effect_handle, effect* e)
+{
+    auto& s = get_state();
+    if(!s.sources.find(src_handle))
+    {
+        src_handle = s.sources.insert(src);
+    }
+    if(!s.effects.find(effect_handle))
+    {
+        effect_handle = s.effects.insert(e);
+    }
+
+    if(is_bound(src_handle, effect_handle))
+    {
+        return;
+    }
+
+    auto& src_links = s.sources.find(src_handle)->links;
+    auto& effect_links = s.effects.find(effect_handle)->links;
+    src_links.push_back({effect_handle, std::uint32_t(effect_links.size())});
+    effect_links.push_back({src_handle, std::uint32_t(src_links.size() - 1)});
+}
+
+void unbind(const binding_handle& src_handle, const binding_handle& effect_handle)
+{
+    auto& s = get_state();
+    auto src_slot = s.sources.find(src_handle);
+    if(!src_slot || !s.effects.find(effect_handle))
+    {
+        return;
+    }
+
+    // the list of a source is the short one
+    auto position = find_link(src_slot->links, effect_handle);
+    if(position == invalid_index)
+    {
+        return;
+    }
+
+    auto other_position = src_slot->links[position].other_slot;
+    remove_link(s.sources, src_handle, position, s.effects);
+    remove_link(s.effects, effect_handle, other_position, s.sources);
+}
+
+auto is_bound(const binding_handle& src_handle, const binding_handle& effect_handle) -> bool
+{
+    auto src_slot = get_state().sources.find(src_handle);
+    return src_slot && find_link(src_slot->links, effect_handle) != invalid_index;
+}
+
+void relocate(const binding_handle& handle, source* src)
+{
+    auto slot = get_state().sources.find(handle);
+    if(slot)
+    {
+        slot->object = src;
+    }
+}
+
+void relocate(const binding_handle& handle, effect* e)
+{
+    auto slot = get_state().effects.find(handle);
+    if(slot)
+    {
+        slot->object = e;
+    }
+}
+
+void release_source(binding_handle& handle)
+{
+    get_state().sources.erase(handle);
+}
+
+void release_effect(binding_handle& handle)
+{
+    get_state().effects.erase(handle);
+}
+
+auto get_effects(const binding_handle& src_handle) -> const std::vector<link>&
+{
+    auto slot = get_state().sources.find(src_handle);
+    return slot ? slot->links : no_links();
+}
+
+auto get_sources(const binding_handle& effect_handle) -> const std::vector<link>&
+{
+    auto slot = get_state().effects.find(effect_handle);
+    return slot ? slot->links : no_links();
+}
+
+auto get_source(const binding_handle& handle) -> source*
+{
+    auto slot = get_state().sources.find(handle);
+    return slot ? slot->object : nullptr;
+}
+
+auto get_effect(const binding_handle& handle) -> effect*
+{
+    auto slot = get_state().effects.find(handle);
+    return slot ? slot->object : nullptr;
+}
+
+} // namespace binding_registry
+} // namespace detail
+} // namespace audio
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../effects/effect.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace audio
+{
+class source;
+class effect;
+
+namespace detail
+{
+
+//-----------------------------------------------------------------------------
+/// Bindings between sources and effects, kept in slot maps addressed by
+/// generational handles. Objects only own their handle, so moving one just
+/// points its slot at the new address, and a handle to a destroyed object
+/// resolves to nullptr instead of a dangling pointer.
+//-----------------------------------------------------------------------------
+namespace binding_registry
+{
+struct link
+{
+    /// the object on the other side
+    binding_handle other;
+    /// position of the reverse link in the list of the other side
+    std::uint32_t other_slot{};
+};
+
+void bind(binding_handle& src_handle, source* src, binding_handle& effect_handle, effect* e);
+void unbind(const binding_handle& src_handle, const binding_handle& effect_handle);
+auto is_bound(const binding_handle& src_handle, const binding_handle& effect_handle) -> bool;
+
+/// points the slot at the new address of a moved object
+void relocate(const binding_handle& handle, source* src);
+void relocate(const binding_handle& handle, effect* e);
+
+/// frees the slot, all the links must be unbound already
+void release_source(binding_handle& handle);
+void release_effect(binding_handle& handle);
+
+/// the effects bound to the source and the sources bound to the effect
+auto get_effects(const binding_handle& src_handle) -> const std::vector<link>&;
+auto get_sources(const binding_handle& effect_handle) -> const std::vector<link>&;
+
+/// nullptr for stale handles
+auto get_source(const binding_handle& handle) -> source*;
+auto get_effect(const binding_handle& handle) -> effect*;
+} // namespace binding_registry
+
+} // namespace detail
+} // namespace audio
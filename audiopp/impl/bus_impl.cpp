@@ -0,0 +1,316 @@
+#include "bus_impl.h"
+#include "../logger.h"
+#include "source_impl.h"
+
+#include <algorithm>
+
+namespace audio
+{
+namespace detail
+{
+namespace
+{
+/// buses with volumes or pitches not applied to their sources yet
+auto get_dirty_buses() -> std::vector<bus_impl*>&
+{
+    static std::vector<bus_impl*> buses;
+    return buses;
+}
+
+/// reused by pause and resume
+auto get_scratch() -> std::vector<source_impl*>&
+{
+    static std::vector<source_impl*> sources;
+    return sources;
+}
+
+template<typename T>
+void erase_value(std::vector<T>& values, const T& value)
+{
+    values.erase(std::remove(std::begin(values), std::end(values), value), std::end(values));
+}
+} // namespace
+
+bus_impl::~bus_impl()
+{
+    if(dirty_)
+    {
+        erase_value(get_dirty_buses(), this);
+    }
+
+    if(parent_ != nullptr)
+    {
+        erase_value(parent_->children_, this);
+    }
+
+    for(auto child : children_)
+    {
+        child->parent_ = nullptr;
+        child->mark_dirty();
+    }
+
+    // the sources keep playing, or stay paused, on their own
+    for(auto source : sources_)
+    {
+        source->set_bus(nullptr, 0);
+        source->set_bus_scale(1.0f, 1.0f);
+    }
+}
+
+auto bus_impl::set_parent(bus_impl* parent) -> bool
+{
+    for(auto ancestor = parent; ancestor != nullptr; ancestor = ancestor->parent_)
+    {
+        if(ancestor == this)
+        {
+            error() << "A bus cannot be its own parent";
+            return false;
+        }
+    }
+
+    if(parent_ != nullptr)
+    {
+        erase_value(parent_->children_, this);
+    }
+
+    parent_ = parent;
+    if(parent_ != nullptr)
+    {
+        parent_->children_.push_back(this);
+    }
+
+    mark_dirty();
+    return true;
+}
+
+auto bus_impl::get_parent() const -> bus_impl*
+{
+    return parent_;
+}
+
+void bus_impl::add(source_impl* source)
+{
+    if(source->get_bus() == this)
+    {
+        return;
+    }
+
+    if(source->get_bus() != nullptr)
+    {
+        source->get_bus()->remove(source);
+    }
+
+    source->set_bus(this, sources_.size());
+    sources_.push_back(source);
+
+    // the scale of a fresh source is applied right away, not only with the next flush
+    source->set_bus_scale(muted_ ? 0.0f : volume_ * get_parent_gain(), pitch_ * get_parent_pitch());
+}
+
+void bus_impl::remove(source_impl* source)
+{
+    if(source->get_bus() != this)
+    {
+        return;
+    }
+
+    // the last source takes its place
+    auto slot = source->get_bus_slot();
+    sources_[slot] = sources_.back();
+    sources_[slot]->set_bus(this, slot);
+    sources_.pop_back();
+
+    source->set_bus(nullptr, 0);
+    source->set_bus_scale(1.0f, 1.0f);
+}
+
+auto bus_impl::get_source_count() const -> size_t
+{
+    return sources_.size();
+}
+
+void bus_impl::set_volume(float volume)
+{
+    volume_ = volume;
+    mark_dirty();
+}
+
+auto bus_impl::get_volume() const -> float
+{
+    return volume_;
+}
+
+void bus_impl::set_pitch(float pitch)
+{
+    pitch_ = pitch;
+    mark_dirty();
+}
+
+auto bus_impl::get_pitch() const -> float
+{
+    return pitch_;
+}
+
+void bus_impl::mute()
+{
+    muted_ = true;
+    mark_dirty();
+}
+
+void bus_impl::unmute()
+{
+    muted_ = false;
+    mark_dirty();
+}
+
+auto bus_impl::is_muted() const -> bool
+{
+    return muted_;
+}
+
+void bus_impl::pause()
+{
+    if(is_paused())
+    {
+        paused_ = true;
+        return;
+    }
+    paused_ = true;
+
+    auto& sources = get_scratch();
+    sources.clear();
+    collect(sources, false);
+
+    // only the playing ones are resumed later
+    sources.erase(std::remove_if(std::begin(sources), std::end(sources),
+                                 [](source_impl* source) { return !source->is_playing(); }),
+                  std::end(sources));
+    for(auto source : sources)
+    {
+        source->set_paused_by_bus(true);
+    }
+
+    source_impl::pause_together(sources);
+}
+
+void bus_impl::resume()
+{
+    if(!paused_)
+    {
+        return;
+    }
+    paused_ = false;
+
+    // still paused along with a parent
+    if(is_paused())
+    {
+        return;
+    }
+
+    auto& sources = get_scratch();
+    sources.clear();
+    collect(sources, true);
+    for(auto source : sources)
+    {
+        source->set_paused_by_bus(false);
+    }
+
+    source_impl::play_together(sources, duration_t::zero());
+}
+
+auto bus_impl::is_paused() const -> bool
+{
+    for(auto bus = this; bus != nullptr; bus = bus->parent_)
+    {
+        if(bus->paused_)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void bus_impl::flush_dirty()
+{
+    auto& buses = get_dirty_buses();
+
+    // indexed, a parent flushed first already cleans the flags of its children
+    for(size_t i = 0; i < buses.size(); ++i)
+    {
+        auto bus = buses[i];
+        if(bus->dirty_)
+        {
+            bus->apply(bus->get_parent_gain(), bus->get_parent_pitch());
+        }
+    }
+    buses.clear();
+}
+
+void bus_impl::mark_dirty()
+{
+    if(!dirty_)
+    {
+        dirty_ = true;
+        get_dirty_buses().push_back(this);
+    }
+}
+
+void bus_impl::apply(float gain, float pitch)
+{
+    dirty_ = false;
+    gain = muted_ ? 0.0f : gain * volume_;
+    pitch *= pitch_;
+
+    for(auto source : sources_)
+    {
+        source->set_bus_scale(gain, pitch);
+    }
+
+    for(auto child : children_)
+    {
+        child->apply(gain, pitch);
+    }
+}
+
+auto bus_impl::get_parent_gain() const -> float
+{
+    float gain = 1.0f;
+    for(auto bus = parent_; bus != nullptr; bus = bus->parent_)
+    {
+        gain *= bus->muted_ ? 0.0f : bus->volume_;
+    }
+    return gain;
+}
+
+auto bus_impl::get_parent_pitch() const -> float
+{
+    float pitch = 1.0f;
+    for(auto bus = parent_; bus != nullptr; bus = bus->parent_)
+    {
+        pitch *= bus->pitch_;
+    }
+    return pitch;
+}
+
+void bus_impl::collect(std::vector<source_impl*>& sources, bool paused_by_bus) const
+{
+    for(auto source : sources_)
+    {
+        if(source->is_paused_by_bus() == paused_by_bus)
+        {
+            sources.push_back(source);
+        }
+    }
+
+    // the buses paused on their own are left as they are
+    for(auto child : children_)
+    {
+        if(!child->paused_)
+        {
+            child->collect(sources, paused_by_bus);
+        }
+    }
+}
+
+} // namespace detail
+} // namespace audio
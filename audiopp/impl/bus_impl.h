@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace audio
+{
+namespace detail
+{
+class source_impl;
+
+class bus_impl
+{
+public:
+    bus_impl() = default;
+    ~bus_impl();
+
+    bus_impl(bus_impl&& rhs) = delete;
+    bus_impl& operator=(bus_impl&& rhs) = delete;
+    bus_impl(const bus_impl& rhs) = delete;
+    bus_impl& operator=(const bus_impl& rhs) = delete;
+
+    auto set_parent(bus_impl* parent) -> bool;
+    auto get_parent() const -> bus_impl*;
+
+    void add(source_impl* source);
+    void remove(source_impl* source);
+    auto get_source_count() const -> size_t;
+
+    void set_volume(float volume);
+    auto get_volume() const -> float;
+    void set_pitch(float pitch);
+    auto get_pitch() const -> float;
+    void mute();
+    void unmute();
+    auto is_muted() const -> bool;
+
+    void pause();
+    void resume();
+    /// paused itself or along with a parent
+    auto is_paused() const -> bool;
+
+    /// applies the changed volumes and pitches to the sources of the buses
+    static void flush_dirty();
+
+private:
+    void mark_dirty();
+    void apply(float gain, float pitch);
+    auto get_parent_gain() const -> float;
+    auto get_parent_pitch() const -> float;
+    /// the sources of this bus and the unpaused buses under it
+    void collect(std::vector<source_impl*>& sources, bool paused_by_bus) const;
+
+    /// non owning
+    bus_impl* parent_{};
+    std::vector<bus_impl*> children_;
+    std::vector<source_impl*> sources_;
+
+    float volume_{1.0f};
+    float pitch_{1.0f};
+    bool muted_{};
+    bool paused_{};
+    /// waits in the list of the buses to flush
+    bool dirty_{};
+};
+} // namespace detail
+} // namespace audio
@@ -87,6 +87,27 @@ auto has_context_thread() noexcept -> bool
     return std::thread::id{} != get_context_thread_id();
 }
 
+auto is_context_thread() noexcept -> bool
+{
+    return std::this_thread::get_id() == get_context_thread_id();
+}
+
+auto get_upload_thread_flag() noexcept -> bool&
+{
+    static thread_local bool upload_thread{};
+    return upload_thread;
+}
+
+void set_upload_thread(bool on) noexcept
+{
+    get_upload_thread_flag() = on;
+}
+
+auto is_upload_thread() noexcept -> bool
+{
+    return get_upload_thread_flag();
+}
+
 void al_check_preconditions()
 {
     if(!has_context_thread())
@@ -94,7 +115,8 @@ void al_check_preconditions()
         throw audio::exception("OpenAL call. No device/context was created.");
     }
 
-    if(std::this_thread::get_id() != get_context_thread_id())
+    // the upload thread has the context made current for itself only
+    if(std::this_thread::get_id() != get_context_thread_id() && !is_upload_thread())
     {
         throw audio::exception(
             "OpenAL call from a different thread than the one the OpenAL context was created in.");
@@ -29,6 +29,9 @@ namespace detail
 ////////////////////////////////////////////////////////////
 void set_context_thread(const std::thread::id& id) noexcept;
 auto has_context_thread() noexcept -> bool;
+auto is_context_thread() noexcept -> bool;
+void set_upload_thread(bool on) noexcept;
+auto is_upload_thread() noexcept -> bool;
 void al_check_preconditions();
 void al_check_error(const char* file, unsigned int line, const char* expression);
 
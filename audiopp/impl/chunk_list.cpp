@@ -0,0 +1,238 @@
+#include "chunk_list.h"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace audio
+{
+namespace detail
+{
+
+namespace
+{
+/// how many free blocks the pool keeps around
+constexpr size_t max_pooled_blocks = 64;
+
+struct block_pool
+{
+    auto acquire() -> chunk_list::byte_array_t
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(!free_blocks.empty())
+            {
+                auto blk = std::move(free_blocks.back());
+                free_blocks.pop_back();
+                return blk;
+            }
+        }
+
+        chunk_list::byte_array_t blk;
+        blk.reserve(chunk_list::block_size);
+        return blk;
+    }
+
+    void release(chunk_list::byte_array_t&& blk)
+    {
+        blk.clear();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if(free_blocks.size() < max_pooled_blocks)
+        {
+            free_blocks.emplace_back(std::move(blk));
+        }
+    }
+
+    std::mutex mutex;
+    std::vector<chunk_list::byte_array_t> free_blocks;
+};
+
+auto get_pool() -> block_pool&
+{
+    static block_pool pool;
+    return pool;
+}
+} // namespace
+
+constexpr size_t chunk_list::block_size;
+
+chunk_list::chunk_list(byte_array_t&& data)
+{
+    append(std::move(data));
+}
+
+chunk_list::~chunk_list()
+{
+    clear();
+}
+
+chunk_list::chunk_list(chunk_list&& rhs) noexcept
+    : blocks_(std::move(rhs.blocks_))
+    , begin_offset_(rhs.begin_offset_)
+    , end_offset_(rhs.end_offset_)
+{
+    // left empty, at the same end offset
+    rhs.blocks_.clear();
+    rhs.begin_offset_ = rhs.end_offset_;
+}
+
+chunk_list& chunk_list::operator=(chunk_list&& rhs) noexcept
+{
+    if(this != &rhs)
+    {
+        clear();
+        blocks_ = std::move(rhs.blocks_);
+        begin_offset_ = rhs.begin_offset_;
+        end_offset_ = rhs.end_offset_;
+        rhs.blocks_.clear();
+        rhs.begin_offset_ = rhs.end_offset_;
+    }
+    return *this;
+}
+
+void chunk_list::append(byte_array_t&& data)
+{
+    if(data.empty())
+    {
+        return;
+    }
+
+    if(data.size() >= block_size)
+    {
+        // big enough to be a block on its own
+        auto size = data.size();
+        blocks_.push_back({std::move(data), end_offset_, false});
+        end_offset_ += size;
+        return;
+    }
+
+    // pack it into the pooled blocks
+    size_t copied = 0;
+    while(copied < data.size())
+    {
+        if(blocks_.empty() || !blocks_.back().pooled || blocks_.back().data.size() == block_size)
+        {
+            blocks_.push_back({get_pool().acquire(), end_offset_, true});
+        }
+
+        auto& tail = blocks_.back().data;
+        auto count = std::min(block_size - tail.size(), data.size() - copied);
+        tail.insert(std::end(tail), data.data() + copied, data.data() + copied + count);
+
+        copied += count;
+        end_offset_ += count;
+    }
+}
+
+auto chunk_list::empty() const -> bool
+{
+    return size() == 0;
+}
+
+auto chunk_list::size() const -> size_t
+{
+    return end_offset_ - begin_offset_;
+}
+
+auto chunk_list::begin_offset() const -> size_t
+{
+    return begin_offset_;
+}
+
+auto chunk_list::end_offset() const -> size_t
+{
+    return end_offset_;
+}
+
+auto chunk_list::data(size_t offset, size_t size, byte_array_t& scratch) const -> const std::uint8_t*
+{
+    if(offset < begin_offset_ || offset + size > end_offset_ || size == 0)
+    {
+        return nullptr;
+    }
+
+    auto it = find(offset);
+    auto local_offset = offset - it->offset;
+    if(local_offset + size <= it->data.size())
+    {
+        return it->data.data() + local_offset;
+    }
+
+    // spans across blocks, so gather it
+    scratch.resize(size);
+    size_t copied = 0;
+    for(; copied < size; ++it, local_offset = 0)
+    {
+        auto count = std::min(it->data.size() - local_offset, size - copied);
+        std::memcpy(scratch.data() + copied, it->data.data() + local_offset, count);
+        copied += count;
+    }
+
+    return scratch.data();
+}
+
+auto chunk_list::take() -> byte_array_t
+{
+    byte_array_t result;
+    if(blocks_.size() == 1 && begin_offset_ == blocks_.front().offset)
+    {
+        result = std::move(blocks_.front().data);
+        blocks_.clear();
+    }
+    else if(!blocks_.empty())
+    {
+        // the range spans multiple blocks so it gets gathered into the result
+        data(begin_offset_, size(), result);
+        clear();
+    }
+
+    begin_offset_ = end_offset_;
+    return result;
+}
+
+void chunk_list::release_until(size_t offset)
+{
+    while(!blocks_.empty())
+    {
+        auto& front = blocks_.front();
+        auto block_end = front.offset + front.data.size();
+        if(block_end > offset)
+        {
+            break;
+        }
+
+        begin_offset_ = block_end;
+        release(front);
+        blocks_.pop_front();
+    }
+}
+
+void chunk_list::clear()
+{
+    for(auto& blk : blocks_)
+    {
+        release(blk);
+    }
+    blocks_.clear();
+    begin_offset_ = end_offset_;
+}
+
+auto chunk_list::find(size_t offset) const -> std::deque<block>::const_iterator
+{
+    // the block containing the offset is the last one starting at or before it
+    auto it = std::upper_bound(std::begin(blocks_), std::end(blocks_), offset,
+                               [](size_t off, const block& blk) { return off < blk.offset; });
+    return std::prev(it);
+}
+
+void chunk_list::release(block& blk)
+{
+    if(blk.pooled)
+    {
+        get_pool().release(std::move(blk.data));
+    }
+}
+
+} // namespace detail
+} // namespace audio
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace audio
+{
+namespace detail
+{
+
+//-----------------------------------------------------------------------------
+/// Segmented byte storage. Appending never moves what is already stored.
+/// Small chunks are packed into fixed size blocks drawn from a shared pool,
+/// bigger ones are adopted as they are. Blocks released from the front go
+/// back to the pool. Offsets are absolute and stay valid when the front is
+/// released.
+//-----------------------------------------------------------------------------
+class chunk_list
+{
+public:
+    using byte_array_t = std::vector<std::uint8_t>;
+
+    /// size of the pooled blocks
+    static constexpr size_t block_size = 64 * 1024;
+
+    chunk_list() = default;
+    chunk_list(byte_array_t&& data);
+    ~chunk_list();
+
+    chunk_list(chunk_list&& rhs) noexcept;
+    chunk_list& operator=(chunk_list&& rhs) noexcept;
+    chunk_list(const chunk_list& rhs) = delete;
+    chunk_list& operator=(const chunk_list& rhs) = delete;
+
+    void append(byte_array_t&& data);
+
+    auto empty() const -> bool;
+    auto size() const -> size_t;
+    auto begin_offset() const -> size_t;
+    auto end_offset() const -> size_t;
+
+    //-----------------------------------------------------------------------------
+    /// Gets a contiguous view of the requested range. It points directly into
+    /// the storage when the range is within a single block, otherwise the range
+    /// is gathered into the scratch buffer.
+    //-----------------------------------------------------------------------------
+    auto data(size_t offset, size_t size, byte_array_t& scratch) const -> const std::uint8_t*;
+
+    //-----------------------------------------------------------------------------
+    /// Moves out all the stored bytes as one contiguous array. A single block
+    /// is handed over without copying.
+    //-----------------------------------------------------------------------------
+    auto take() -> byte_array_t;
+
+    //-----------------------------------------------------------------------------
+    /// Releases the blocks which end before the offset.
+    //-----------------------------------------------------------------------------
+    void release_until(size_t offset);
+
+    void clear();
+
+private:
+    struct block
+    {
+        byte_array_t data;
+        /// absolute offset of the first byte
+        size_t offset{};
+        /// drawn from the pool
+        bool pooled{};
+    };
+
+    auto find(size_t offset) const -> std::deque<block>::const_iterator;
+    void release(block& blk);
+
+    std::deque<block> blocks_;
+    /// absolute offset of the first stored byte
+    size_t begin_offset_{};
+    /// absolute offset past the last stored byte
+    size_t end_offset_{};
+};
+
+} // namespace detail
+} // namespace audio
@@ -3,6 +3,14 @@
 #include "../exception.h"
 #include "../logger.h"
 #include "check.h"
+#include "extensions.h"
+#include "filter_pool.h"
+#include "oneshot_pool.h"
+#include "sound_impl.h"
+#include "source_events.h"
+#include "update_batch.h"
+#include "upload_thread.h"
+#include "voice_pool.h"
 
 #include <al.h>
 #include <efx.h>
@@ -94,6 +102,32 @@ static auto alc_extensions(ALCdevice* dev) -> std::string
     return ss.str();
 }
 
+static auto alc_render_channels(std::uint8_t channels) -> ALCenum
+{
+    switch(channels)
+    {
+        case 1:
+            return ALC_MONO_SOFT;
+        case 2:
+            return ALC_STEREO_SOFT;
+        case 4:
+            return ALC_QUAD_SOFT;
+        case 6:
+            return ALC_5POINT1_SOFT;
+        case 7:
+            return ALC_6POINT1_SOFT;
+        case 8:
+            return ALC_7POINT1_SOFT;
+        default:
+            return 0;
+    }
+}
+
+static auto alc_render_type(render_type type) -> ALCenum
+{
+    return type == render_type::float32 ? ALC_FLOAT_SOFT : ALC_SHORT_SOFT;
+}
+
 static auto alc_get_max_aux_slots_per_source(ALCdevice* dev) ->std::string
 {
 
@@ -138,17 +172,71 @@ device_impl::device_impl(const std::string& id)
     info() << "Selected audio playback device:";
     info() << "-- " << device_id_;
 
-    bool has_efx = openal::al_has_extension(device_.get(), "ALC_EXT_EFX");
+    init({});
+}
 
-    ALint attribs[4] = {0};
-    attribs[0] = ALC_MAX_AUXILIARY_SENDS;
-    attribs[1] = 3;
+device_impl::device_impl(const render_format& format)
+    : format_(format)
+{
+    if(has_context_thread())
+    {
+        throw audio::exception("OpenAL call. Device/context was already created.");
+    }
+
+    if(!load_loopback_extension(loopback_))
+    {
+        error() << "ALC_SOFT_loopback is not supported";
+        throw audio::exception("ALC_SOFT_loopback is not supported");
+    }
+
+    auto channels = openal::alc_render_channels(format.channels);
+    auto type = openal::alc_render_type(format.type);
+
+    device_.reset(loopback_.alcLoopbackOpenDeviceSOFT(nullptr));
+    device_id_ = "loopback";
+
+    if(device_ == nullptr)
+    {
+        error() << "Cant open audio loopback device";
+        throw audio::exception("Cant open audio loopback device");
+    }
+
+    if(channels == 0 ||
+       loopback_.alcIsRenderFormatSupportedSOFT(device_.get(), ALCsizei(format.sample_rate), channels, type) !=
+           ALC_TRUE)
+    {
+        error() << "Unsupported loopback render format: " << format.sample_rate << " hz, "
+                << uint32_t(format.channels) << " channels";
+        throw audio::exception("Unsupported loopback render format");
+    }
+
+    info() << "Selected audio loopback device:";
+    info() << "-- " << format.sample_rate << " hz, " << uint32_t(format.channels) << " channels, "
+           << (format.type == render_type::float32 ? "float32" : "int16");
+
+    // after the checks, a device which failed to open
+    // must not keep another one from being created
+    set_context_thread(std::this_thread::get_id());
+    init({ALC_FORMAT_CHANNELS_SOFT, channels, ALC_FORMAT_TYPE_SOFT, type, ALC_FREQUENCY,
+          ALCint(format.sample_rate)});
+}
+
+void device_impl::init(std::vector<ALCint> attribs)
+{
+    bool has_efx = openal::al_has_extension(device_.get(), "ALC_EXT_EFX");
+    if(has_efx)
+    {
+        attribs.push_back(ALC_MAX_AUXILIARY_SENDS);
+        attribs.push_back(3);
+    }
+    attribs.push_back(0);
 
     // create context
-    context_.reset(alcCreateContext(device_.get(), has_efx ? attribs : nullptr));
+    context_.reset(alcCreateContext(device_.get(), attribs.data()));
 
     if(context_ == nullptr)
     {
+        set_context_thread(std::thread::id{});
         error() << "Cant create audio context for playback device: " << device_id_;
         throw audio::exception("Cant create audio context for playback device: " + device_id_);
     }
@@ -164,11 +252,27 @@ device_impl::device_impl(const std::string& id)
     info() << "-- " << openal::alc_extensions(device_.get());
     info() << "-- " << openal::alc_get_max_aux_slots_per_source(device_.get());
 
+    load_extensions(device_.get());
+    voice_pool::init(device_.get());
+    filter_pool::init(device_.get());
+    source_events::init();
+    start_upload_thread(context_.get());
+
     al_check(alDistanceModel(AL_LINEAR_DISTANCE));
 }
 
 device_impl::~device_impl()
 {
+    stop_upload_thread();
+
+    // sounds released on other threads still own buffers
+    sound_impl::release_pending();
+
+    oneshot_pool::shutdown();
+    source_events::shutdown();
+    voice_pool::shutdown();
+    filter_pool::shutdown();
+    unload_extensions();
     set_context_thread(std::thread::id{});
 }
 
@@ -182,6 +286,16 @@ void device_impl::disable()
     al_check(alcMakeContextCurrent(nullptr));
 }
 
+void device_impl::begin_update()
+{
+    update_batch::begin();
+}
+
+void device_impl::end_update()
+{
+    update_batch::end();
+}
+
 auto device_impl::is_valid() const -> bool
 {
     return (device_ != nullptr) && (context_ != nullptr);
@@ -207,6 +321,51 @@ auto device_impl::get_extensions() const -> const std::string&
     return extensions_;
 }
 
+auto device_impl::get_render_format() const -> const render_format&
+{
+    return format_;
+}
+
+auto device_impl::get_render_frame_size() const -> size_t
+{
+    return size_t(format_.channels) * (format_.type == render_type::float32 ? sizeof(float) : sizeof(std::int16_t));
+}
+
+void device_impl::render(size_t frames, void* out)
+{
+    if(loopback_.alcRenderSamplesSOFT == nullptr)
+    {
+        return;
+    }
+
+    loopback_.alcRenderSamplesSOFT(device_.get(), out, ALCsizei(frames));
+}
+
+auto device_impl::is_render_format_supported(const render_format& format) -> bool
+{
+    loopback_extension ext;
+    if(!load_loopback_extension(ext))
+    {
+        return false;
+    }
+
+    auto channels = openal::alc_render_channels(format.channels);
+    if(channels == 0)
+    {
+        return false;
+    }
+
+    // the format is checked against a device of its own
+    std::unique_ptr<ALCdevice, deleter> device(ext.alcLoopbackOpenDeviceSOFT(nullptr));
+    if(device == nullptr)
+    {
+        return false;
+    }
+
+    return ext.alcIsRenderFormatSupportedSOFT(device.get(), ALCsizei(format.sample_rate), channels,
+                                              openal::alc_render_type(format.type)) == ALC_TRUE;
+}
+
 auto device_impl::enumerate_capture_devices() -> std::vector<std::string>
 {
     return openal::al_get_strings(nullptr, ALC_CAPTURE_DEVICE_SPECIFIER);
@@ -1,4 +1,7 @@
 #pragma once
+#include "../loopback_device.h"
+#include "extensions.h"
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -13,11 +16,16 @@ class device_impl
 {
 public:
     device_impl(const std::string& id = {});
+    /// mixes into memory in the format, over ALC_SOFT_loopback
+    device_impl(const render_format& format);
     ~device_impl();
 
     void enable();
     void disable();
 
+    void begin_update();
+    void end_update();
+
     auto is_valid() const -> bool;
 
     auto get_device_id() const -> const std::string&;
@@ -25,12 +33,20 @@ public:
     auto get_vendor() const -> const std::string&;
     auto get_extensions() const -> const std::string&;
 
+    auto get_render_format() const -> const render_format&;
+    auto get_render_frame_size() const -> size_t;
+    void render(size_t frames, void* out);
+    static auto is_render_format_supported(const render_format& format) -> bool;
+
     static auto enumerate_playback_devices() -> std::vector<std::string>;
     static auto enumerate_capture_devices() -> std::vector<std::string>;
     static auto default_playback_device() -> std::string;
     static auto default_capture_device() -> std::string;
 
 private:
+    /// creates the context of the opened device with the attributes
+    void init(std::vector<ALCint> attribs);
+
     struct deleter
     {
         void operator()(ALCdevice* obj);
@@ -45,6 +61,10 @@ private:
     std::string version_;
     std::string vendor_;
     std::string extensions_;
+
+    /// set for loopback devices only
+    loopback_extension loopback_{};
+    render_format format_{};
 };
 } // namespace detail
 } // namespace audio
@@ -0,0 +1,110 @@
+#include "extensions.h"
+#include "../logger.h"
+
+namespace audio
+{
+namespace detail
+{
+
+namespace
+{
+auto get_mutable_extensions() -> extensions&
+{
+    static extensions ext;
+    return ext;
+}
+
+template <typename T>
+auto load_proc(T& proc, const char* name) -> bool
+{
+    proc = reinterpret_cast<T>(alGetProcAddress(name));
+    return proc != nullptr;
+}
+
+template <typename T>
+auto load_proc(ALCdevice* device, T& proc, const char* name) -> bool
+{
+    proc = reinterpret_cast<T>(alcGetProcAddress(device, name));
+    return proc != nullptr;
+}
+} // namespace
+
+auto load_loopback_extension(loopback_extension& ext) -> bool
+{
+    ext = {};
+    if(alcIsExtensionPresent(nullptr, "ALC_SOFT_loopback") != ALC_TRUE)
+    {
+        return false;
+    }
+
+    return load_proc(nullptr, ext.alcLoopbackOpenDeviceSOFT, "alcLoopbackOpenDeviceSOFT") &&
+           load_proc(nullptr, ext.alcIsRenderFormatSupportedSOFT, "alcIsRenderFormatSupportedSOFT") &&
+           load_proc(nullptr, ext.alcRenderSamplesSOFT, "alcRenderSamplesSOFT");
+}
+
+void load_extensions(ALCdevice* device)
+{
+    auto& ext = get_mutable_extensions();
+    ext = {};
+
+    if(alIsExtensionPresent("AL_EXT_STATIC_BUFFER") == AL_TRUE)
+    {
+        ext.static_buffer = load_proc(ext.alBufferDataStatic, "alBufferDataStatic");
+    }
+
+    if(alIsExtensionPresent("AL_SOFT_deferred_updates") == AL_TRUE)
+    {
+        ext.deferred_updates = load_proc(ext.alDeferUpdatesSOFT, "alDeferUpdatesSOFT") &&
+                               load_proc(ext.alProcessUpdatesSOFT, "alProcessUpdatesSOFT");
+    }
+
+    if(alIsExtensionPresent("AL_SOFT_events") == AL_TRUE)
+    {
+        ext.events = load_proc(ext.alEventControlSOFT, "alEventControlSOFT") &&
+                     load_proc(ext.alEventCallbackSOFT, "alEventCallbackSOFT");
+    }
+
+    ext.loop_points = alIsExtensionPresent("AL_SOFT_loop_points") == AL_TRUE;
+
+    if(alIsExtensionPresent("AL_SOFT_source_latency") == AL_TRUE)
+    {
+        ext.source_latency = load_proc(ext.alGetSourcei64vSOFT, "alGetSourcei64vSOFT");
+    }
+
+    if(alIsExtensionPresent("AL_SOFT_source_start_delay") == AL_TRUE)
+    {
+        ext.source_start_delay = load_proc(ext.alSourcePlayAtTimevSOFT, "alSourcePlayAtTimevSOFT");
+    }
+
+    if(alcIsExtensionPresent(device, "ALC_SOFT_device_clock") == ALC_TRUE)
+    {
+        ext.device_clock = load_proc(device, ext.alcGetInteger64vSOFT, "alcGetInteger64vSOFT");
+    }
+
+    if(alcIsExtensionPresent(device, "ALC_EXT_thread_local_context") == ALC_TRUE)
+    {
+        ext.thread_local_context = load_proc(device, ext.alcSetThreadContext, "alcSetThreadContext");
+    }
+
+    info() << "-- Static buffers : " << (ext.static_buffer ? "yes" : "no");
+    info() << "-- Deferred updates : " << (ext.deferred_updates ? "yes" : "no");
+    info() << "-- Thread local context : " << (ext.thread_local_context ? "yes" : "no");
+    info() << "-- Source events : " << (ext.events ? "yes" : "no");
+    info() << "-- Loop points : " << (ext.loop_points ? "yes" : "no");
+    info() << "-- Source latency : " << (ext.source_latency ? "yes" : "no");
+    info() << "-- Source start delay : " << (ext.source_start_delay ? "yes" : "no");
+    info() << "-- Device clock : " << (ext.device_clock ? "yes" : "no");
+}
+
+void unload_extensions()
+{
+    get_mutable_extensions() = {};
+}
+
+auto get_extensions() -> const extensions&
+{
+    return get_mutable_extensions();
+}
+
+} // namespace detail
+} // namespace audio
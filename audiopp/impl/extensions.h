@@ -0,0 +1,123 @@
+#pragma once
+
+#include <al.h>
+#include <alc.h>
+
+#include <cstdint>
+
+#ifndef AL_EVENT_TYPE_BUFFER_COMPLETED_SOFT
+#define AL_EVENT_TYPE_BUFFER_COMPLETED_SOFT 0x19A4
+#endif
+#ifndef AL_EVENT_TYPE_SOURCE_STATE_CHANGED_SOFT
+#define AL_EVENT_TYPE_SOURCE_STATE_CHANGED_SOFT 0x19A5
+#endif
+#ifndef ALC_DEVICE_CLOCK_SOFT
+#define ALC_DEVICE_CLOCK_SOFT 0x1600
+#endif
+#ifndef AL_LOOP_POINTS_SOFT
+#define AL_LOOP_POINTS_SOFT 0x2015
+#endif
+#ifndef AL_SAMPLE_OFFSET_LATENCY_SOFT
+#define AL_SAMPLE_OFFSET_LATENCY_SOFT 0x1200
+#endif
+#ifndef AL_SAMPLE_OFFSET_CLOCK_SOFT
+#define AL_SAMPLE_OFFSET_CLOCK_SOFT 0x1202
+#endif
+#ifndef ALC_FORMAT_CHANNELS_SOFT
+#define ALC_FORMAT_CHANNELS_SOFT 0x1990
+#define ALC_FORMAT_TYPE_SOFT 0x1991
+#define ALC_SHORT_SOFT 0x1402
+#define ALC_FLOAT_SOFT 0x1406
+#define ALC_MONO_SOFT 0x1500
+#define ALC_STEREO_SOFT 0x1501
+#define ALC_QUAD_SOFT 0x1503
+#define ALC_5POINT1_SOFT 0x1504
+#define ALC_6POINT1_SOFT 0x1505
+#define ALC_7POINT1_SOFT 0x1506
+#endif
+
+namespace audio
+{
+namespace detail
+{
+
+/// AL_EXT_STATIC_BUFFER
+using buffer_data_static_proc = void(AL_APIENTRY*)(ALuint, ALenum, ALvoid*, ALsizei, ALsizei);
+/// AL_SOFT_deferred_updates
+using deferred_updates_proc = void(AL_APIENTRY*)();
+/// ALC_EXT_thread_local_context
+using set_thread_context_proc = ALCboolean(ALC_APIENTRY*)(ALCcontext*);
+/// AL_SOFT_events
+using event_handler_proc = void(AL_APIENTRY*)(ALenum, ALuint, ALuint, ALsizei, const ALchar*, void*);
+using event_control_proc = void(AL_APIENTRY*)(ALsizei, const ALenum*, ALboolean);
+using event_callback_proc = void(AL_APIENTRY*)(event_handler_proc, void*);
+/// ALC_SOFT_device_clock
+using get_integer64v_proc = void(ALC_APIENTRY*)(ALCdevice*, ALCenum, ALsizei, std::int64_t*);
+/// AL_SOFT_source_latency
+using get_source_i64v_proc = void(AL_APIENTRY*)(ALuint, ALenum, std::int64_t*);
+/// AL_SOFT_source_start_delay
+using play_at_timev_proc = void(AL_APIENTRY*)(ALsizei, const ALuint*, std::int64_t);
+/// ALC_SOFT_loopback
+using loopback_open_device_proc = ALCdevice*(ALC_APIENTRY*)(const ALCchar*);
+using is_render_format_supported_proc = ALCboolean(ALC_APIENTRY*)(ALCdevice*, ALCsizei, ALCenum, ALCenum);
+using render_samples_proc = void(ALC_APIENTRY*)(ALCdevice*, ALCvoid*, ALCsizei);
+
+//-----------------------------------------------------------------------------
+/// Optional OpenAL extensions the library makes use of when available.
+/// Loaded once the context is created.
+//-----------------------------------------------------------------------------
+struct extensions
+{
+    /// buffers which read directly from application owned memory
+    bool static_buffer{};
+    buffer_data_static_proc alBufferDataStatic{};
+
+    /// property changes can be held back and applied at once
+    bool deferred_updates{};
+    deferred_updates_proc alDeferUpdatesSOFT{};
+    deferred_updates_proc alProcessUpdatesSOFT{};
+
+    /// a context can be made current for a single thread only
+    bool thread_local_context{};
+    set_thread_context_proc alcSetThreadContext{};
+
+    /// the mixer reports source state changes and completed buffers
+    bool events{};
+    event_control_proc alEventControlSOFT{};
+    event_callback_proc alEventCallbackSOFT{};
+
+    /// the time of the device clock can be queried, in nanoseconds
+    bool device_clock{};
+    get_integer64v_proc alcGetInteger64vSOFT{};
+
+    /// looping buffers can jump back to a frame other than the first one
+    bool loop_points{};
+
+    /// the playback position of a source can be queried with its latency
+    bool source_latency{};
+    get_source_i64v_proc alGetSourcei64vSOFT{};
+
+    /// sources can be started at a time of the device clock
+    bool source_start_delay{};
+    play_at_timev_proc alSourcePlayAtTimevSOFT{};
+};
+
+//-----------------------------------------------------------------------------
+/// ALC_SOFT_loopback, loaded before any device exists.
+//-----------------------------------------------------------------------------
+struct loopback_extension
+{
+    loopback_open_device_proc alcLoopbackOpenDeviceSOFT{};
+    is_render_format_supported_proc alcIsRenderFormatSupportedSOFT{};
+    render_samples_proc alcRenderSamplesSOFT{};
+};
+
+/// returns false if the extension is not available
+auto load_loopback_extension(loopback_extension& ext) -> bool;
+
+void load_extensions(ALCdevice* device);
+void unload_extensions();
+auto get_extensions() -> const extensions&;
+
+} // namespace detail
+} // namespace audio
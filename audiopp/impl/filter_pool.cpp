@@ -0,0 +1,147 @@
+#include "filter_pool.h"
+#include "../logger.h"
+#include "check.h"
+
+#include <efx.h>
+
+#include <array>
+
+namespace audio
+{
+namespace detail
+{
+namespace filter_pool
+{
+
+namespace
+{
+constexpr size_t filter_type_count = 4;
+
+struct state
+{
+    bool supported{};
+
+    LPALGENFILTERS alGenFilters{};
+    LPALDELETEFILTERS alDeleteFilters{};
+    LPALFILTERI alFilteri{};
+    LPALFILTERF alFilterf{};
+
+    /// one object per filter type, created when first needed
+    std::array<ALuint, filter_type_count> objects{};
+    /// the parameters the objects hold, to skip setting them again
+    std::array<filter, filter_type_count> params{};
+};
+
+auto get_state() -> state&
+{
+    static state s;
+    return s;
+}
+
+template <typename T>
+auto load_proc(T& proc, const char* name) -> bool
+{
+    proc = reinterpret_cast<T>(alGetProcAddress(name));
+    return proc != nullptr;
+}
+
+auto get_al_type(filter::filter_type type) -> ALint
+{
+    switch(type)
+    {
+        case filter::filter_type::lowpass:
+            return AL_FILTER_LOWPASS;
+        case filter::filter_type::highpass:
+            return AL_FILTER_HIGHPASS;
+        case filter::filter_type::bandpass:
+            return AL_FILTER_BANDPASS;
+        default:
+            return AL_FILTER_NULL;
+    }
+}
+
+void set_params(const state& s, ALuint object, const filter& params)
+{
+    switch(params.type)
+    {
+        case filter::filter_type::lowpass:
+            al_check(s.alFilterf(object, AL_LOWPASS_GAIN, params.gain));
+            al_check(s.alFilterf(object, AL_LOWPASS_GAINHF, params.gainhf));
+            break;
+        case filter::filter_type::highpass:
+            al_check(s.alFilterf(object, AL_HIGHPASS_GAIN, params.gain));
+            al_check(s.alFilterf(object, AL_HIGHPASS_GAINLF, params.gainlf));
+            break;
+        case filter::filter_type::bandpass:
+            al_check(s.alFilterf(object, AL_BANDPASS_GAIN, params.gain));
+            al_check(s.alFilterf(object, AL_BANDPASS_GAINLF, params.gainlf));
+            al_check(s.alFilterf(object, AL_BANDPASS_GAINHF, params.gainhf));
+            break;
+        default:
+            break;
+    }
+}
+} // namespace
+
+void init(ALCdevice* device)
+{
+    auto& s = get_state();
+    s = {};
+
+    if(alcIsExtensionPresent(device, "ALC_EXT_EFX") == ALC_TRUE)
+    {
+        s.supported = load_proc(s.alGenFilters, "alGenFilters") &&
+                      load_proc(s.alDeleteFilters, "alDeleteFilters") &&
+                      load_proc(s.alFilteri, "alFilteri") && load_proc(s.alFilterf, "alFilterf");
+    }
+
+    info() << "-- Direct filters : " << (s.supported ? "yes" : "no");
+}
+
+void shutdown()
+{
+    auto& s = get_state();
+    for(auto& object : s.objects)
+    {
+        if(object != 0)
+        {
+            al_check(s.alDeleteFilters(1, &object));
+        }
+    }
+    s = {};
+}
+
+auto is_supported() -> bool
+{
+    return get_state().supported;
+}
+
+auto prepare(const filter& params) -> ALuint
+{
+    auto& s = get_state();
+    if(!s.supported || params.type == filter::filter_type::none)
+    {
+        return AL_FILTER_NULL;
+    }
+
+    auto index = static_cast<size_t>(params.type);
+    auto& object = s.objects[index];
+    if(object == 0)
+    {
+        al_check(s.alGenFilters(1, &object));
+        al_check(s.alFilteri(object, AL_FILTER_TYPE, get_al_type(params.type)));
+        set_params(s, object, params);
+        s.params[index] = params;
+    }
+    else if(s.params[index] != params)
+    {
+        set_params(s, object, params);
+        s.params[index] = params;
+    }
+
+    return object;
+}
+
+} // namespace filter_pool
+} // namespace detail
+} // namespace audio
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../filter.h"
+
+#include <al.h>
+#include <alc.h>
+
+namespace audio
+{
+namespace detail
+{
+
+//-----------------------------------------------------------------------------
+/// OpenAL filter objects shared by all the sources. A source copies the
+/// parameters of the filter it is given, so a single object per filter
+/// type is enough.
+//-----------------------------------------------------------------------------
+namespace filter_pool
+{
+/// loads the filter functions when ALC_EXT_EFX is supported
+void init(ALCdevice* device);
+/// deletes the filter objects
+void shutdown();
+auto is_supported() -> bool;
+
+/// gets a filter object set up with the parameters, AL_FILTER_NULL for none
+auto prepare(const filter& params) -> ALuint;
+} // namespace filter_pool
+
+} // namespace detail
+} // namespace audio
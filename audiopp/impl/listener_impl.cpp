@@ -1,31 +1,102 @@
 #include "listener_impl.h"
 #include "check.h"
+#include "update_batch.h"
 #include <al.h>
 
 namespace audio
 {
 namespace detail
 {
+namespace
+{
+float3 current_position{};
+}
+
+listener_impl::~listener_impl()
+{
+    if(dirty_ != 0)
+    {
+        update_batch::forget(this);
+    }
+}
+
 void listener_impl::set_volume(float volume)
 {
-    al_check(alListenerf(AL_GAIN, volume));
+    volume_ = volume;
+    if(!defer(dirty_gain))
+    {
+        al_check(alListenerf(AL_GAIN, volume));
+    }
 }
 
 void listener_impl::set_position(const float3& position)
 {
-    al_check(alListenerfv(AL_POSITION, position.data()));
+    position_ = position;
+    current_position = position;
+    if(!defer(dirty_position))
+    {
+        al_check(alListenerfv(AL_POSITION, position.data()));
+    }
 }
 
 void listener_impl::set_velocity(const float3& velocity)
 {
-    al_check(alListenerfv(AL_VELOCITY, velocity.data()));
+    velocity_ = velocity;
+    if(!defer(dirty_velocity))
+    {
+        al_check(alListenerfv(AL_VELOCITY, velocity.data()));
+    }
 }
 
 void listener_impl::set_orientation(const float3& direction, const float3& up)
 {
     // orientation { norm(at), norm(up) };
-    float orientation6[] = {-direction[0], -direction[1], -direction[2], up[0], up[1], up[2]};
-    al_check(alListenerfv(AL_ORIENTATION, orientation6));
+    orientation_ = {{-direction[0], -direction[1], -direction[2], up[0], up[1], up[2]}};
+    if(!defer(dirty_orientation))
+    {
+        al_check(alListenerfv(AL_ORIENTATION, orientation_.data()));
+    }
+}
+
+void listener_impl::flush_properties()
+{
+    if(dirty_ & dirty_gain)
+    {
+        al_check(alListenerf(AL_GAIN, volume_));
+    }
+    if(dirty_ & dirty_position)
+    {
+        al_check(alListenerfv(AL_POSITION, position_.data()));
+    }
+    if(dirty_ & dirty_velocity)
+    {
+        al_check(alListenerfv(AL_VELOCITY, velocity_.data()));
+    }
+    if(dirty_ & dirty_orientation)
+    {
+        al_check(alListenerfv(AL_ORIENTATION, orientation_.data()));
+    }
+    dirty_ = 0;
+}
+
+auto listener_impl::get_current_position() -> const float3&
+{
+    return current_position;
+}
+
+auto listener_impl::defer(std::uint8_t property) -> bool
+{
+    if(!update_batch::is_active())
+    {
+        return false;
+    }
+
+    if(dirty_ == 0)
+    {
+        update_batch::mark_dirty(this);
+    }
+    dirty_ |= property;
+    return true;
 }
 } // namespace detail
 } // namespace audio
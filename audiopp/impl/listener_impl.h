@@ -1,5 +1,7 @@
 #pragma once
 #include "../types.h"
+#include <array>
+#include <cstdint>
 
 namespace audio
 {
@@ -8,10 +10,39 @@ namespace detail
 class listener_impl
 {
 public:
+    listener_impl() = default;
+    ~listener_impl();
+    listener_impl(const listener_impl& rhs) = delete;
+    listener_impl& operator=(const listener_impl& rhs) = delete;
+
     void set_volume(float volume);
     void set_position(const float3& position);
     void set_velocity(const float3& velocity);
     void set_orientation(const float3& direction, const float3& up);
+
+    void flush_properties();
+
+    /// position last set on the listener, there is one per context
+    static auto get_current_position() -> const float3&;
+
+private:
+    auto defer(std::uint8_t property) -> bool;
+
+    enum dirty_property : std::uint8_t
+    {
+        dirty_gain = 1 << 0,
+        dirty_position = 1 << 1,
+        dirty_velocity = 1 << 2,
+        dirty_orientation = 1 << 3
+    };
+
+    /// shadow copies of the properties last set
+    float volume_{1.0f};
+    float3 position_{};
+    float3 velocity_{};
+    std::array<float, 6> orientation_{{0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f}};
+    /// properties set during an update batch, not flushed yet
+    std::uint8_t dirty_{};
 };
 } // namespace detail
 } // namespace audio
@@ -0,0 +1,155 @@
+#include "memory_budget.h"
+#include "../logger.h"
+#include "check.h"
+#include "sound_impl.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace audio
+{
+namespace detail
+{
+namespace memory_budget
+{
+
+namespace
+{
+struct entry
+{
+    /// position in the lru list
+    std::list<sound_impl*>::iterator it;
+    size_t bytes{};
+};
+
+struct state
+{
+    std::mutex mutex;
+    /// least recently used first
+    std::list<sound_impl*> lru;
+    std::unordered_map<sound_impl*, entry> entries;
+    sound_memory_stats stats;
+};
+
+auto get_state() -> state&
+{
+    static state s;
+    return s;
+}
+
+void enforce(state& s)
+{
+    if(s.stats.budget == 0)
+    {
+        return;
+    }
+
+    for(auto it = std::begin(s.lru); it != std::end(s.lru) && s.stats.resident_bytes > s.stats.budget;)
+    {
+        auto sound = *it;
+        auto& e = s.entries[sound];
+        if(e.bytes == 0 || !sound->evict())
+        {
+            ++it;
+            continue;
+        }
+
+        trace() << "Evicted sound " << sound->get_info().id << " (" << e.bytes << " bytes)";
+
+        s.stats.resident_bytes -= e.bytes;
+        s.stats.evictions++;
+        s.stats.evicted_bytes += e.bytes;
+        e.bytes = 0;
+        ++it;
+    }
+}
+} // namespace
+
+void set_budget(size_t bytes)
+{
+    auto& s = get_state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.stats.budget = bytes;
+
+    // evicting destroys openal buffers, otherwise
+    // it happens on the next bind or unbind
+    if(!has_context_thread() || is_context_thread())
+    {
+        enforce(s);
+    }
+}
+
+auto get_stats() -> sound_memory_stats
+{
+    auto& s = get_state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    return s.stats;
+}
+
+void track(sound_impl* sound, size_t bytes)
+{
+    auto& s = get_state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto it = s.entries.find(sound);
+    if(it == std::end(s.entries))
+    {
+        entry e;
+        e.it = s.lru.insert(std::end(s.lru), sound);
+        it = s.entries.emplace(sound, e).first;
+    }
+
+    auto& e = it->second;
+    s.stats.resident_bytes -= e.bytes;
+    s.stats.resident_bytes += bytes;
+    e.bytes = bytes;
+}
+
+void untrack(sound_impl* sound)
+{
+    auto& s = get_state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto it = s.entries.find(sound);
+    if(it == std::end(s.entries))
+    {
+        return;
+    }
+
+    s.stats.resident_bytes -= it->second.bytes;
+    s.lru.erase(it->second.it);
+    s.entries.erase(it);
+}
+
+void touch(sound_impl* sound, bool reloaded)
+{
+    auto& s = get_state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    auto it = s.entries.find(sound);
+    if(it != std::end(s.entries))
+    {
+        s.lru.splice(std::end(s.lru), s.lru, it->second.it);
+    }
+
+    if(reloaded)
+    {
+        s.stats.reloads++;
+    }
+    else
+    {
+        s.stats.hits++;
+    }
+}
+
+void enforce()
+{
+    auto& s = get_state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    enforce(s);
+}
+
+} // namespace memory_budget
+} // namespace detail
+} // namespace audio
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../sound_budget.h"
+
+namespace audio
+{
+namespace detail
+{
+class sound_impl;
+
+//-----------------------------------------------------------------------------
+/// Bookkeeping of the bytes resident per sound, in least recently used order.
+//-----------------------------------------------------------------------------
+namespace memory_budget
+{
+void set_budget(size_t bytes);
+auto get_stats() -> sound_memory_stats;
+
+/// updates the resident size of the sound
+void track(sound_impl* sound, size_t bytes);
+void untrack(sound_impl* sound);
+
+/// marks the sound as the most recently used one
+void touch(sound_impl* sound, bool reloaded);
+
+/// evicts idle sounds until the resident bytes fit the budget
+void enforce();
+} // namespace memory_budget
+
+} // namespace detail
+} // namespace audio
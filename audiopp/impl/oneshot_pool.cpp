@@ -0,0 +1,187 @@
+#include "oneshot_pool.h"
+#include "../source.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace audio
+{
+namespace detail
+{
+namespace oneshot_pool
+{
+
+namespace
+{
+constexpr size_t default_max_oneshots = 128;
+
+struct state
+{
+    /// grown on demand while less than the limit play, never shrunk
+    std::vector<std::unique_ptr<source>> sources;
+    /// whether the source at the same index is playing a one-shot
+    std::vector<std::uint8_t> busy;
+    /// indices of the sources not playing
+    std::vector<size_t> free;
+
+    size_t max_oneshots{default_max_oneshots};
+    oneshot_stats stats;
+};
+
+auto get_state() -> state&
+{
+    static state s;
+    return s;
+}
+
+void recycle(state& s, size_t index)
+{
+    if(s.busy[index] == 0)
+    {
+        return;
+    }
+
+    // the sound may be evicted once no one-shot holds it
+    s.sources[index]->unbind();
+    s.busy[index] = 0;
+    s.free.push_back(index);
+    s.stats.playing--;
+}
+
+void grow(state& s)
+{
+    auto index = s.sources.size();
+    s.sources.emplace_back(std::make_unique<source>());
+    s.busy.push_back(0);
+    s.free.push_back(index);
+    s.stats.pooled++;
+
+    // set once, so that playing does not allocate
+    s.sources[index]->on_stopped([index](source&) { recycle(get_state(), index); });
+}
+
+/// takes back the sources which stopped without anyone noticing,
+/// e.g. virtual ones far from the listener or ones whose sound was unbound
+void reclaim(state& s)
+{
+    for(size_t i = 0; i < s.sources.size(); ++i)
+    {
+        if(s.busy[i] != 0 && !s.sources[i]->is_playing())
+        {
+            recycle(s, i);
+        }
+    }
+}
+
+auto take(state& s, size_t& index) -> source*
+{
+    if(s.stats.playing >= s.max_oneshots)
+    {
+        reclaim(s);
+        if(s.stats.playing >= s.max_oneshots)
+        {
+            return nullptr;
+        }
+    }
+
+    if(s.free.empty())
+    {
+        grow(s);
+    }
+
+    index = s.free.back();
+    s.free.pop_back();
+    s.busy[index] = 1;
+    s.stats.playing++;
+    return s.sources[index].get();
+}
+
+template<typename T>
+auto play_sound(const T& snd, const oneshot_params& params) -> bool
+{
+    auto& s = get_state();
+    size_t index = 0;
+    auto src = take(s, index);
+    if(src == nullptr)
+    {
+        s.stats.dropped++;
+        return false;
+    }
+
+    // everything is set each time, the previous one-shot may have set it otherwise
+    src->bind(snd);
+    if(!src->has_bound_sound())
+    {
+        // an empty sound or a stale handle, there is nothing to play
+        recycle(s, index);
+        return false;
+    }
+
+    src->set_volume(params.volume);
+    src->set_pitch(params.pitch);
+    src->set_volume_rolloff(params.rolloff);
+    src->set_distance(params.min_distance, params.max_distance);
+    src->set_position(params.position);
+    src->set_priority(params.priority);
+    src->play();
+
+    s.stats.played++;
+    return true;
+}
+} // namespace
+
+auto play(const sound& snd, const oneshot_params& params) -> bool
+{
+    return play_sound(snd, params);
+}
+
+auto play(const sound_handle& snd, const oneshot_params& params) -> bool
+{
+    return play_sound(snd, params);
+}
+
+void stop_all()
+{
+    auto& s = get_state();
+    for(size_t i = 0; i < s.sources.size(); ++i)
+    {
+        if(s.busy[i] != 0)
+        {
+            s.sources[i]->stop();
+            recycle(s, i);
+        }
+    }
+}
+
+void shutdown()
+{
+    auto& s = get_state();
+    s.sources.clear();
+    s.busy.clear();
+    s.free.clear();
+    s.stats.pooled = 0;
+    s.stats.playing = 0;
+}
+
+void set_max_oneshots(size_t count)
+{
+    get_state().max_oneshots = count;
+}
+
+auto get_max_oneshots() -> size_t
+{
+    return get_state().max_oneshots;
+}
+
+auto get_stats() -> oneshot_stats
+{
+    auto& s = get_state();
+    auto stats = s.stats;
+    stats.max_oneshots = s.max_oneshots;
+    return stats;
+}
+
+} // namespace oneshot_pool
+} // namespace detail
+} // namespace audio
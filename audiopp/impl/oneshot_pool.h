@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../oneshot.h"
+
+namespace audio
+{
+namespace detail
+{
+
+//-----------------------------------------------------------------------------
+/// Sources reused for fire-and-forget playback.
+//-----------------------------------------------------------------------------
+namespace oneshot_pool
+{
+auto play(const sound& snd, const oneshot_params& params) -> bool;
+auto play(const sound_handle& snd, const oneshot_params& params) -> bool;
+void stop_all();
+/// destroys the pooled sources while the device is still alive
+void shutdown();
+
+void set_max_oneshots(size_t count);
+auto get_max_oneshots() -> size_t;
+auto get_stats() -> oneshot_stats;
+} // namespace oneshot_pool
+
+} // namespace detail
+} // namespace audio
@@ -0,0 +1,359 @@
+#include "playlist_impl.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace audio
+{
+namespace detail
+{
+namespace
+{
+constexpr float half_pi = 1.57079632679f;
+
+auto get_playlists() -> std::vector<playlist_impl*>&
+{
+    static std::vector<playlist_impl*> playlists;
+    return playlists;
+}
+} // namespace
+
+playlist_impl::playlist_impl()
+{
+    get_playlists().push_back(this);
+
+    for(auto& voice : voices_)
+    {
+        voice.on_stopped([this](source& src)
+        {
+            // played through, stopping on request doesn't call back
+            if(&src == &voices_[active_])
+            {
+                ended_ = true;
+            }
+        });
+    }
+}
+
+playlist_impl::~playlist_impl()
+{
+    auto& playlists = get_playlists();
+    playlists.erase(std::remove(std::begin(playlists), std::end(playlists), this), std::end(playlists));
+}
+
+void playlist_impl::add(const sound_handle& snd)
+{
+    tracks_.push_back(snd);
+
+    // the last track gets a successor
+    prefetch();
+}
+
+void playlist_impl::clear()
+{
+    stop();
+    tracks_.clear();
+    current_ = 0;
+}
+
+auto playlist_impl::get_track_count() const -> size_t
+{
+    return tracks_.size();
+}
+
+auto playlist_impl::get_current_track() const -> size_t
+{
+    return current_;
+}
+
+void playlist_impl::set_crossfade(duration_t duration)
+{
+    crossfade_ = std::max(duration, duration_t::zero());
+
+    if(crossfade_ > duration_t::zero() && queued_)
+    {
+        // the next track fades in on the other voice instead
+        voices_[active_].clear_queue();
+        queued_ = false;
+    }
+    prefetch();
+}
+
+auto playlist_impl::get_crossfade() const -> duration_t
+{
+    return crossfade_;
+}
+
+void playlist_impl::set_loop(bool on)
+{
+    looping_ = on;
+
+    if(!looping_ && queued_ && get_next_track(current_) == npos)
+    {
+        // the first track was queued after the last one
+        voices_[active_].clear_queue();
+        queued_ = false;
+    }
+    prefetch();
+}
+
+auto playlist_impl::is_looping() const -> bool
+{
+    return looping_;
+}
+
+void playlist_impl::set_volume(float volume)
+{
+    volume_ = volume;
+    apply_fade();
+}
+
+auto playlist_impl::get_volume() const -> float
+{
+    return volume_;
+}
+
+void playlist_impl::play()
+{
+    if(paused_)
+    {
+        paused_ = false;
+        if(fading_)
+        {
+            // resumed in the same mix to keep the crossfade in step
+            source::play_together({&voices_[0], &voices_[1]});
+        }
+        else
+        {
+            voices_[active_].resume();
+        }
+        return;
+    }
+
+    if(playing_ || tracks_.empty())
+    {
+        return;
+    }
+
+    start(std::min(current_, tracks_.size() - 1), false);
+}
+
+void playlist_impl::play_track(size_t index)
+{
+    if(index >= tracks_.size())
+    {
+        return;
+    }
+
+    paused_ = false;
+    if(!playing_ || crossfade_ == duration_t::zero())
+    {
+        start(index, false);
+        return;
+    }
+
+    // the track fading out already makes room
+    if(fading_)
+    {
+        auto& out = voices_[1 - active_];
+        out.stop();
+        out.unbind();
+    }
+
+    active_ = 1 - active_;
+    start(index, true);
+}
+
+void playlist_impl::next()
+{
+    auto index = get_next_track(current_);
+    if(index == npos)
+    {
+        stop();
+        current_ = 0;
+        return;
+    }
+
+    play_track(index);
+}
+
+void playlist_impl::stop()
+{
+    for(auto& voice : voices_)
+    {
+        voice.stop();
+        voice.unbind();
+    }
+
+    playing_ = false;
+    paused_ = false;
+    fading_ = false;
+    queued_ = false;
+    ended_ = false;
+}
+
+void playlist_impl::pause()
+{
+    if(!playing_ || paused_)
+    {
+        return;
+    }
+
+    paused_ = true;
+    for(auto& voice : voices_)
+    {
+        voice.pause();
+    }
+}
+
+auto playlist_impl::is_playing() const -> bool
+{
+    return playing_ && !paused_;
+}
+
+auto playlist_impl::is_paused() const -> bool
+{
+    return paused_;
+}
+
+auto playlist_impl::get_source(size_t index) -> source&
+{
+    return voices_[std::min(index, voices_.size() - 1)];
+}
+
+void playlist_impl::update_all(duration_t dt)
+{
+    // indexed, a playlist may be destroyed by the callbacks of its sources
+    auto& playlists = get_playlists();
+    for(size_t i = 0; i < playlists.size(); ++i)
+    {
+        playlists[i]->update(dt);
+    }
+}
+
+void playlist_impl::update(duration_t dt)
+{
+    if(!playing_ || paused_)
+    {
+        return;
+    }
+
+    if(fading_)
+    {
+        fade_elapsed_ += dt;
+        if(fade_elapsed_ >= crossfade_)
+        {
+            fading_ = false;
+            auto& out = voices_[1 - active_];
+            out.stop();
+            out.unbind();
+            prefetch();
+        }
+        apply_fade();
+    }
+
+    auto& voice = voices_[active_];
+    if(queued_ && voice.get_queued_sound_count() == 0)
+    {
+        // the source moved on to the queued track without a gap
+        current_ = get_next_track(current_);
+        queued_ = false;
+        prefetch();
+    }
+
+    if(ended_)
+    {
+        // nothing could be queued, e.g. the formats differ
+        ended_ = false;
+        auto index = get_next_track(current_);
+        if(index == npos)
+        {
+            stop();
+            current_ = 0;
+            return;
+        }
+
+        start(index, false);
+        return;
+    }
+
+    if(crossfade_ > duration_t::zero() && !fading_)
+    {
+        auto index = get_next_track(current_);
+        auto remaining = voice.get_playback_duration() - voice.get_playback_position();
+        if(index != npos && remaining <= crossfade_)
+        {
+            active_ = 1 - active_;
+            start(index, true);
+        }
+    }
+}
+
+auto playlist_impl::get_next_track(size_t index) const -> size_t
+{
+    if(index + 1 < tracks_.size())
+    {
+        return index + 1;
+    }
+    return (looping_ && !tracks_.empty()) ? 0 : npos;
+}
+
+void playlist_impl::start(size_t index, bool fade_in)
+{
+    auto& voice = voices_[active_];
+
+    // binding clears whatever was queued on the voice
+    voice.bind(tracks_[index]);
+    current_ = index;
+    queued_ = false;
+    ended_ = false;
+    playing_ = true;
+    paused_ = false;
+
+    fading_ = fade_in;
+    fade_elapsed_ = duration_t::zero();
+    apply_fade();
+
+    voice.play();
+    prefetch();
+}
+
+void playlist_impl::prefetch()
+{
+    if(!playing_ || queued_ || fading_)
+    {
+        return;
+    }
+
+    auto index = get_next_track(current_);
+    if(index == npos)
+    {
+        return;
+    }
+
+    if(crossfade_ == duration_t::zero())
+    {
+        // uploaded or opened ahead and played right after the current one
+        queued_ = voices_[active_].queue(tracks_[index]);
+        return;
+    }
+
+    // bound ahead, so that its data is resident by the time it fades in
+    voices_[1 - active_].bind(tracks_[index]);
+}
+
+void playlist_impl::apply_fade()
+{
+    if(!fading_)
+    {
+        voices_[active_].set_volume(volume_);
+        return;
+    }
+
+    // equal power, the summed power stays the same all along
+    auto t = std::min(float(fade_elapsed_.count() / crossfade_.count()), 1.0f);
+    voices_[active_].set_volume(volume_ * std::sin(t * half_pi));
+    voices_[1 - active_].set_volume(volume_ * std::cos(t * half_pi));
+}
+} // namespace detail
+} // namespace audio
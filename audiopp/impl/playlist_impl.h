@@ -0,0 +1,86 @@
+#pragma once
+
+#include "../sound.h"
+#include "../source.h"
+#include "../types.h"
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace audio
+{
+namespace detail
+{
+
+class playlist_impl
+{
+public:
+    playlist_impl();
+    ~playlist_impl();
+
+    playlist_impl(playlist_impl&& rhs) = delete;
+    playlist_impl& operator=(playlist_impl&& rhs) = delete;
+    playlist_impl(const playlist_impl& rhs) = delete;
+    playlist_impl& operator=(const playlist_impl& rhs) = delete;
+
+    void add(const sound_handle& snd);
+    void clear();
+    auto get_track_count() const -> size_t;
+    auto get_current_track() const -> size_t;
+
+    void set_crossfade(duration_t duration);
+    auto get_crossfade() const -> duration_t;
+    void set_loop(bool on);
+    auto is_looping() const -> bool;
+    void set_volume(float volume);
+    auto get_volume() const -> float;
+
+    void play();
+    void play_track(size_t index);
+    void next();
+    void stop();
+    void pause();
+    auto is_playing() const -> bool;
+    auto is_paused() const -> bool;
+
+    auto get_source(size_t index) -> source&;
+
+    /// moves the playlists on to their next tracks
+    static void update_all(duration_t dt);
+
+private:
+    void update(duration_t dt);
+    /// the track after the index, npos once played through
+    auto get_next_track(size_t index) const -> size_t;
+    /// plays the track on the active voice, fading in if set
+    void start(size_t index, bool fade_in);
+    /// queues the next track after the current one, or binds it to the idle voice
+    void prefetch();
+    void apply_fade();
+
+    static constexpr size_t npos = size_t(-1);
+
+    std::vector<sound_handle> tracks_;
+    size_t current_{};
+    /// the track after the current one is queued on the active voice
+    bool queued_{};
+    /// the active voice played through on its own
+    bool ended_{};
+
+    /// the active voice plays the current track, the other one fades out
+    std::array<source, 2> voices_;
+    size_t active_{};
+
+    duration_t crossfade_{};
+    /// time since the current track started fading in
+    duration_t fade_elapsed_{};
+    bool fading_{};
+
+    float volume_{1.0f};
+    bool looping_{};
+    bool playing_{};
+    bool paused_{};
+};
+} // namespace detail
+} // namespace audio
@@ -1,9 +1,14 @@
 #include "sound_impl.h"
+#include "../loaders/decoder_cursor.h"
 #include "../logger.h"
 #include "check.h"
+#include "extensions.h"
+#include "memory_budget.h"
 #include "source_impl.h"
+#include "upload_thread.h"
 #include <algorithm>
-#include <cstring>
+#include <array>
+#include <atomic>
 
 namespace audio
 {
@@ -59,9 +64,62 @@ static auto get_format(const sound_info& info) -> ALenum
     return format;
 }
 
-} // namespace detail
+/// smaller uploads are not worth handing over to the upload thread
+constexpr size_t offthread_upload_min_size = 256 * 1024;
+
+/// streams straight from the resident pcm data
+class pcm_cursor : public stream_cursor
+{
+public:
+    pcm_cursor(const chunk_list& data)
+        : data_(data)
+        , offset_(data.begin_offset())
+    {
+    }
 
-using namespace std::chrono_literals;
+    void seek(size_t offset) override
+    {
+        offset_ = std::min(std::max(offset, data_.begin_offset()), data_.end_offset());
+    }
+
+    auto tell() const -> size_t override
+    {
+        return offset_;
+    }
+
+    auto read(size_t desired_size, const std::uint8_t*& data) -> size_t override
+    {
+        if(offset_ >= data_.end_offset())
+        {
+            return 0;
+        }
+
+        // get the actual chunk size depending on how much is left
+        auto chunk_size = std::min(data_.end_offset() - offset_, desired_size);
+        data = data_.data(offset_, chunk_size, scratch_);
+        if(!data)
+        {
+            return 0;
+        }
+
+        offset_ += chunk_size;
+        return chunk_size;
+    }
+
+private:
+    const chunk_list& data_;
+    size_t offset_{};
+    /// gathers ranges spanning multiple blocks of the data
+    std::vector<std::uint8_t> scratch_;
+};
+
+/// sounds released on another thread waiting
+/// to be destroyed on the context thread
+static std::mutex pending_release_mutex;
+static std::vector<sound_impl*> pending_release;
+static std::atomic<bool> has_pending_release{false};
+
+} // namespace detail
 
 sound_impl::sound_impl() = default;
 sound_impl::sound_impl(std::vector<std::uint8_t>&& buffer, sound_info&& info, bool stream /*= false*/)
@@ -69,77 +127,196 @@ sound_impl::sound_impl(std::vector<std::uint8_t>&& buffer, sound_info&& info, bo
     , info_(std::move(info))
     , stream_(stream)
 {
+    update_resident_size();
+}
+
+sound_impl::sound_impl(encoded_sound_data&& data)
+    : encoded_(std::move(data.data))
+    , codec_(data.codec)
+    , info_(std::move(data.info))
+    , stream_(true)
+{
+    update_resident_size();
 }
 
 sound_impl::~sound_impl()
 {
+    memory_budget::untrack(this);
     unbind_from_all_sources();
 
+    if(upload_ && !abandon_upload(*upload_))
+    {
+        handles_.emplace_back(upload_->buffer);
+    }
+
     if(!handles_.empty())
     {
         al_check(alDeleteBuffers(ALsizei(handles_.size()), handles_.data()));
     }
 }
 
-auto sound_impl::upload_chunk() -> bool
+void sound_impl::release(sound_impl* sound)
 {
-    if(stream_)
+    // openal objects can only be destroyed on the context thread
+    if(!has_context_thread() || is_context_thread())
+    {
+        delete sound;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(detail::pending_release_mutex);
+    detail::pending_release.emplace_back(sound);
+    detail::has_pending_release = true;
+}
+
+void sound_impl::release_pending()
+{
+    if(!detail::has_pending_release)
     {
-        return upload_chunk(get_byte_size_for(1s));
+        return;
     }
 
-    return upload_chunk(data_.size());
+    auto sounds = []() {
+        std::lock_guard<std::mutex> lock(detail::pending_release_mutex);
+        detail::has_pending_release = false;
+        return std::move(detail::pending_release);
+    }();
+
+    for(auto sound : sounds)
+    {
+        delete sound;
+    }
 }
 
-auto sound_impl::upload_chunk(size_t desired_size) -> bool
+auto sound_impl::upload_chunk() -> bool
 {
+    if(stream_)
+    {
+        // streamed sounds are uploaded by the sources
+        // into their own ring of buffers
+        return false;
+    }
+
+    pump_feed();
+
+    if(upload_)
+    {
+        return finish_upload();
+    }
+
     if(data_.empty())
     {
         return false;
     }
 
-    // get the actual chunk size depending on how much is left in the buffer
-    auto chunk_size = std::min(data_.size() - data_offset_, desired_size);
+    // upload everything there is. The data gets consumed and its blocks recycled.
+    auto data = data_.take();
+    auto size = data.size();
     auto format = detail::get_format(info_);
+    const auto& ext = get_extensions();
+
+    uploaded_bytes_ += size;
+    update_resident_size();
+
+    if(size >= detail::offthread_upload_min_size && has_upload_thread())
+    {
+        // big uploads would stall the context thread, the
+        // buffer is picked up by a later update once ready
+        upload_ = std::make_shared<upload_ticket>();
+        upload_->data = std::move(data);
+        upload_->format = format;
+        upload_->sample_rate = ALsizei(info_.sample_rate);
+        upload_->use_static = ext.static_buffer;
+        post_upload(upload_);
+        return false;
+    }
 
     native_handle_type h{0};
     al_check(alGenBuffers(1, &h));
-    al_check(alBufferData(h, format, data_.data() + data_offset_, ALsizei(chunk_size),
-                          ALsizei(info_.sample_rate)));
 
-    // add the handle for bookkeeping
-    handles_.emplace_back(h);
+    if(ext.static_buffer)
+    {
+        // let openal read directly from our memory rather than copying it.
+        // The data is kept alive for as long as the buffer exists.
+        al_check(ext.alBufferDataStatic(h, format, data.data(), ALsizei(data.size()),
+                                        ALsizei(info_.sample_rate)));
+        static_data_.emplace_back(std::move(data));
+    }
+    else
+    {
+        al_check(alBufferData(h, format, data.data(), ALsizei(data.size()), ALsizei(info_.sample_rate)));
+    }
 
-    data_offset_ += chunk_size;
+    add_buffer(h);
+    return true;
+}
 
+auto sound_impl::finish_upload() -> bool
+{
+    if(upload_->status != upload_ticket::state::done)
     {
-        // enqueue the newly created buffer
-        // to all the bound sources
-        std::lock_guard<std::mutex> lock(mutex_);
-        for(auto source : bound_to_sources_)
-        {
-            source->enqueue_buffers(&handles_.back(), 1);
-        }
+        return false;
     }
 
-    if(data_offset_ == data_.size())
+    auto ticket = std::move(upload_);
+    if(ticket->use_static)
     {
-        // force deallocate and clear out the data
-        std::vector<uint8_t>().swap(data_);
-        data_offset_ = 0;
+        static_data_.emplace_back(std::move(ticket->data));
     }
 
+    add_buffer(ticket->buffer);
     return true;
 }
 
-auto sound_impl::upload_until(size_t desired_size) -> bool
+void sound_impl::add_buffer(native_handle_type buffer)
 {
-    if(data_offset_ >= desired_size)
+    // only possible while no source uses the buffer. The points are
+    // within a buffer, openal can't loop over a part of a queue
+    if(handles_.empty())
     {
-        return true;
+        apply_loop_points(buffer);
     }
-    auto left_size = desired_size - data_offset_;
-    return upload_chunk(left_size);
+    else
+    {
+        loop_points_applied_ = false;
+    }
+
+    // add the handle for bookkeeping
+    handles_.emplace_back(buffer);
+
+    // enqueue the newly created buffer
+    // to all the bound sources
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(auto source : bound_to_sources_)
+    {
+        source->on_buffer_uploaded(handles_.back());
+    }
+}
+
+auto sound_impl::create_stream_cursor() const -> std::unique_ptr<stream_cursor>
+{
+    if(!encoded_.empty())
+    {
+        // every source gets a decoder of its own
+        return create_decoder_cursor(encoded_.data(), encoded_.size(), codec_, info_);
+    }
+    return std::make_unique<detail::pcm_cursor>(data_);
+}
+
+auto sound_impl::stream_to(native_handle_type buffer, stream_cursor& cursor, size_t desired_size) const
+    -> size_t
+{
+    const std::uint8_t* data = nullptr;
+    auto chunk_size = cursor.read(desired_size, data);
+    if(chunk_size == 0)
+    {
+        return 0;
+    }
+
+    auto format = detail::get_format(info_);
+    al_check(alBufferData(buffer, format, data, ALsizei(chunk_size), ALsizei(info_.sample_rate)));
+
+    return chunk_size;
 }
 
 auto sound_impl::get_info() const -> const sound_info&
@@ -148,10 +325,38 @@ auto sound_impl::get_info() const -> const sound_info&
 }
 
 auto sound_impl::get_byte_size_for(duration_t desired_duration) const -> size_t
+{
+    // keep it aligned to whole frames
+    auto frames = static_cast<size_t>(desired_duration.count() * double(info_.sample_rate));
+    return frames * get_frame_size();
+}
+
+auto sound_impl::get_frame_size() const -> size_t
 {
     auto bytes_per_sample = info_.bits_per_sample / 8u;
-    return static_cast<size_t>(desired_duration.count() *
-                               double(info_.sample_rate * info_.channels * bytes_per_sample));
+    return size_t(info_.channels * bytes_per_sample);
+}
+
+auto sound_impl::is_streaming() const -> bool
+{
+    return stream_;
+}
+
+auto sound_impl::is_uploaded() const -> bool
+{
+    if(stream_ || upload_ || !data_.empty() || handles_.empty())
+    {
+        return false;
+    }
+    return !feed_ || (feed_->closed && feed_->queue.empty());
+}
+
+auto sound_impl::can_follow(const sound_impl& other) const -> bool
+{
+    // openal only queues buffers of the same format together
+    return stream_ == other.stream_ && info_.channels == other.info_.channels &&
+           info_.bits_per_sample == other.info_.bits_per_sample &&
+           info_.sample_rate == other.info_.sample_rate;
 }
 
 auto sound_impl::append_chunk(std::vector<uint8_t>&& data) -> bool
@@ -160,23 +365,111 @@ auto sound_impl::append_chunk(std::vector<uint8_t>&& data) -> bool
     {
         return false;
     }
-    if(data_.empty())
+
+    if(!feed_)
     {
-        data_ = std::move(data);
+        data_.append(std::move(data));
+        update_resident_size();
+        return true;
     }
-    else
+
+    // called from the producer thread. Hand the chunk
+    // over without ever waiting for the consumer.
+    if(feed_->closed)
     {
-        auto sz = data_.size();
-        data_.resize(sz + data.size());
-        std::memcpy(data_.data() + sz, data.data(), data.size());
+        feed_->overruns++;
+        return false;
     }
 
+    auto size = data.size();
+    if(!feed_->queue.try_push(std::move(data)))
+    {
+        feed_->overruns++;
+        return false;
+    }
+
+    feed_->fed_chunks++;
+    feed_->fed_bytes += size;
     return true;
 }
 
+void sound_impl::open_feed(size_t capacity, underrun_policy policy)
+{
+    feed_ = std::make_unique<feed>(std::max<size_t>(capacity, 1), policy);
+}
+
+void sound_impl::close_feed()
+{
+    if(feed_)
+    {
+        feed_->closed = true;
+    }
+}
+
+auto sound_impl::get_feed_stats() const -> feed_stats
+{
+    feed_stats stats;
+    if(feed_)
+    {
+        stats.fed_chunks = feed_->fed_chunks;
+        stats.fed_bytes = feed_->fed_bytes;
+        stats.overruns = feed_->overruns;
+        stats.underruns = feed_->underruns;
+    }
+    return stats;
+}
+
+auto sound_impl::is_waiting_for_data() -> bool
+{
+    pump_feed();
+
+    if(!feed_ || feed_->policy != underrun_policy::wait)
+    {
+        return false;
+    }
+
+    // closed is checked first, everything pushed before closing is visible then
+    return !(feed_->closed && feed_->queue.empty());
+}
+
+void sound_impl::pump_feed()
+{
+    if(!feed_)
+    {
+        return;
+    }
+
+    bool fed = false;
+    std::vector<std::uint8_t> chunk;
+    while(feed_->queue.try_pop(chunk))
+    {
+        data_.append(std::move(chunk));
+        fed = true;
+    }
+
+    if(fed)
+    {
+        release_streamed();
+        update_resident_size();
+    }
+}
+
+void sound_impl::on_underrun()
+{
+    if(feed_)
+    {
+        feed_->underruns++;
+    }
+}
+
+auto sound_impl::get_stream_begin() const -> size_t
+{
+    return data_.begin_offset();
+}
+
 auto sound_impl::is_valid() const -> bool
 {
-    return !handles_.empty() || !data_.empty();
+    return !handles_.empty() || !data_.empty() || !encoded_.empty() || upload_ || feed_ || evicted_;
 }
 
 auto sound_impl::native_handles() const -> const std::vector<native_handle_type>&
@@ -186,16 +479,28 @@ auto sound_impl::native_handles() const -> const std::vector<native_handle_type>
 
 void sound_impl::bind_to_source(source_impl* source)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    bound_to_sources_.push_back(source);
+    make_resident();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bound_to_sources_.push_back(source);
+    }
+
+    // now that this one is in use others may have to make room for it
+    memory_budget::enforce();
 }
 
 void sound_impl::unbind_from_source(source_impl* source)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    bound_to_sources_.erase(std::remove_if(std::begin(bound_to_sources_), std::end(bound_to_sources_),
-                                           [source](const auto& item) { return item == source; }),
-                            std::end(bound_to_sources_));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bound_to_sources_.erase(std::remove_if(std::begin(bound_to_sources_), std::end(bound_to_sources_),
+                                               [source](const auto& item) { return item == source; }),
+                                std::end(bound_to_sources_));
+    }
+
+    // it may be idle now
+    memory_budget::enforce();
 }
 
 void sound_impl::unbind_from_all_sources()
@@ -210,6 +515,231 @@ void sound_impl::unbind_from_all_sources()
     {
         source->unbind();
     }
+
+    auto queued_sources = [&]() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::move(queued_on_sources_);
+    }();
+
+    for(auto& source : queued_sources)
+    {
+        source->forget_queued_sound(this);
+    }
+}
+
+void sound_impl::queue_on_source(source_impl* source)
+{
+    make_resident();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_on_sources_.push_back(source);
+    }
+
+    memory_budget::enforce();
+}
+
+void sound_impl::unqueue_from_source(source_impl* source)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find(std::begin(queued_on_sources_), std::end(queued_on_sources_), source);
+    if(it != std::end(queued_on_sources_))
+    {
+        queued_on_sources_.erase(it);
+    }
+}
+
+void sound_impl::set_reload_recipe(reload_recipe recipe)
+{
+    reload_ = std::move(recipe);
+}
+
+auto sound_impl::set_loop_points(std::uint64_t start_frame, std::uint64_t end_frame) -> bool
+{
+    auto end = end_frame == 0 ? info_.frames : end_frame;
+    if(start_frame >= end || (info_.frames != 0 && end > info_.frames))
+    {
+        error() << "Invalid loop points " << start_frame << "-" << end_frame << " for sound " << info_.id;
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!handles_.empty() && (!bound_to_sources_.empty() || !queued_on_sources_.empty()))
+        {
+            error() << "Loop points of sound " << info_.id << " can't change while bound to or queued on a source";
+            return false;
+        }
+    }
+
+    loop_start_ = start_frame;
+    loop_end_ = end_frame;
+
+    if(stream_)
+    {
+        return true;
+    }
+
+    if(!get_extensions().loop_points)
+    {
+        info() << "AL_SOFT_loop_points is not supported, sound " << info_.id << " loops as a whole";
+        return false;
+    }
+
+    if(handles_.empty())
+    {
+        // set on the buffer once uploaded, fed sounds get several of them
+        return !feed_;
+    }
+
+    if(handles_.size() == 1)
+    {
+        apply_loop_points(handles_.front());
+    }
+    else
+    {
+        info() << "Loop points of sound " << info_.id << " only apply to streaming, it is split into several buffers";
+    }
+    return loop_points_applied_;
+}
+
+auto sound_impl::get_loop_start() const -> std::uint64_t
+{
+    return loop_start_;
+}
+
+auto sound_impl::get_loop_end() const -> std::uint64_t
+{
+    return loop_end_ == 0 ? info_.frames : loop_end_;
+}
+
+auto sound_impl::has_loop_points() const -> bool
+{
+    return loop_start_ != 0 || loop_end_ != 0;
+}
+
+auto sound_impl::are_loop_points_applied() const -> bool
+{
+    return stream_ || loop_points_applied_;
+}
+
+void sound_impl::apply_loop_points(native_handle_type buffer)
+{
+    loop_points_applied_ = false;
+    if(stream_ || !get_extensions().loop_points)
+    {
+        return;
+    }
+
+    ALint size = 0;
+    al_check(alGetBufferi(buffer, AL_SIZE, &size));
+    // the first of several fed buffers doesn't reach the end of the loop
+    auto frames = std::uint64_t(size) / get_frame_size();
+    if(frames == 0 || get_loop_end() > frames)
+    {
+        return;
+    }
+
+    const std::array<ALint, 2> points{{ALint(loop_start_), ALint(get_loop_end())}};
+    al_check(alBufferiv(buffer, AL_LOOP_POINTS_SOFT, points.data()));
+    loop_points_applied_ = true;
+}
+
+auto sound_impl::evict() -> bool
+{
+    // encoded sounds are already small and would only come back as pcm
+    if(!reload_ || feed_ || upload_ || !encoded_.empty())
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(!bound_to_sources_.empty() || !queued_on_sources_.empty())
+        {
+            return false;
+        }
+    }
+
+    if(!handles_.empty())
+    {
+        al_check(alDeleteBuffers(ALsizei(handles_.size()), handles_.data()));
+        handles_.clear();
+    }
+
+    loop_points_applied_ = false;
+    static_data_.clear();
+    data_.clear();
+    uploaded_bytes_ = 0;
+    evicted_ = true;
+    return true;
+}
+
+void sound_impl::make_resident()
+{
+    if(!evicted_)
+    {
+        memory_budget::touch(this, false);
+        return;
+    }
+
+    sound_data data;
+    if(!reload_(data))
+    {
+        error() << "Failed to reload sound " << info_.id;
+        return;
+    }
+
+    // the sources, the queues and the loop points rely on the info
+    const auto& info = data.info;
+    if(info.channels != info_.channels || info.sample_rate != info_.sample_rate ||
+       info.bits_per_sample != info_.bits_per_sample || info.frames != info_.frames ||
+       data.data.size() != info_.frames * get_frame_size())
+    {
+        error() << "Failed to reload sound " << info_.id << ". The data reloaded doesn't match its format";
+        return;
+    }
+
+    // the buffers get uploaded again on the next update like at first
+    data_ = chunk_list(std::move(data.data));
+    evicted_ = false;
+
+    memory_budget::touch(this, true);
+    update_resident_size();
+}
+
+void sound_impl::update_resident_size()
+{
+    memory_budget::track(this, data_.size() + encoded_.size() + uploaded_bytes_);
+}
+
+void sound_impl::release_streamed()
+{
+    if(!stream_)
+    {
+        return;
+    }
+
+    // a fed stream may go on forever, so drop what all
+    // of the sources streaming it have already passed
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(bound_to_sources_.empty())
+    {
+        return;
+    }
+
+    auto offset = data_.end_offset();
+    for(auto source : bound_to_sources_)
+    {
+        // looping sources will need it all again
+        if(source->is_looping())
+        {
+            return;
+        }
+        offset = std::min(offset, source->get_stream_offset());
+    }
+
+    data_.release_until(offset);
 }
 
 } // namespace detail
@@ -1,7 +1,13 @@
 #pragma once
 
-#include "../sound_info.h"
+#include "../sound_data.h"
+#include "../sound_feed.h"
+#include "chunk_list.h"
+#include "spsc_queue.h"
+#include "stream_cursor.h"
 #include <al.h>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <vector>
 
@@ -10,6 +16,7 @@ namespace audio
 namespace detail
 {
 class source_impl;
+struct upload_ticket;
 
 class sound_impl
 {
@@ -19,6 +26,10 @@ public:
     sound_impl();
     ~sound_impl();
     sound_impl(std::vector<std::uint8_t>&& buffer, sound_info&& info, bool stream = false);
+    sound_impl(encoded_sound_data&& data);
+
+    static void release(sound_impl* sound);
+    static void release_pending();
 
     sound_impl(sound_impl&& rhs) = delete;
     sound_impl& operator=(sound_impl&& rhs) = delete;
@@ -31,28 +42,104 @@ public:
     auto append_chunk(std::vector<uint8_t>&& data) -> bool;
     auto get_info() const -> const sound_info&;
     auto get_byte_size_for(duration_t desired_duration) const -> size_t;
+    auto get_frame_size() const -> size_t;
+    auto is_streaming() const -> bool;
+    /// all of the data is in the buffer handles
+    auto is_uploaded() const -> bool;
+    /// whether the data can be played right after the data of the other sound
+    auto can_follow(const sound_impl& other) const -> bool;
+
+    void open_feed(size_t capacity, underrun_policy policy);
+    void close_feed();
+    auto get_feed_stats() const -> feed_stats;
+    auto is_waiting_for_data() -> bool;
+    void pump_feed();
+    void on_underrun();
+
+    void set_reload_recipe(reload_recipe recipe);
+
+    auto set_loop_points(std::uint64_t start_frame, std::uint64_t end_frame) -> bool;
+    auto get_loop_start() const -> std::uint64_t;
+    /// the frame the loop ends at, the frames of the sound if not set
+    auto get_loop_end() const -> std::uint64_t;
+    auto has_loop_points() const -> bool;
+    /// streamed sounds always loop within the points, static ones once set on their buffer
+    auto are_loop_points_applied() const -> bool;
+    auto evict() -> bool;
+
+    auto get_stream_begin() const -> size_t;
+    auto create_stream_cursor() const -> std::unique_ptr<stream_cursor>;
+    auto stream_to(native_handle_type buffer, stream_cursor& cursor, size_t desired_size) const -> size_t;
 
 private:
     friend class source_impl;
 
-    auto upload_chunk(size_t desired_size) -> bool;
-    auto upload_until(size_t desired_size) -> bool;
     void bind_to_source(source_impl* source);
     void unbind_from_source(source_impl* source);
     void unbind_from_all_sources();
+    /// to play after the sound bound to the source
+    void queue_on_source(source_impl* source);
+    void unqueue_from_source(source_impl* source);
+    void release_streamed();
+    auto finish_upload() -> bool;
+    void add_buffer(native_handle_type buffer);
+    void make_resident();
+    void update_resident_size();
+    void apply_loop_points(native_handle_type buffer);
+
+    struct feed
+    {
+        feed(size_t capacity, underrun_policy policy)
+            : queue(capacity)
+            , policy(policy)
+        {
+        }
+
+        /// chunks handed over from the producer thread
+        spsc_queue<std::vector<std::uint8_t>> queue;
+        underrun_policy policy{};
+        /// the producer won't append anything anymore
+        std::atomic<bool> closed{false};
+        std::atomic<std::uint64_t> fed_chunks{0};
+        std::atomic<std::uint64_t> fed_bytes{0};
+        std::atomic<std::uint64_t> overruns{0};
+        std::atomic<std::uint64_t> underruns{0};
+    };
 
-    /// created buffer handles
+    /// created buffer handles. Streamed sounds don't own any, every
+    /// source streaming them keeps its own ring of buffers instead
     std::vector<native_handle_type> handles_;
-    /// transient data valid until the audio is being streamed from memory
-    std::vector<std::uint8_t> data_;
-    /// offset into the data buffer to upload from
-    size_t data_offset_{0};
+    /// transient data valid until the audio is uploaded. Streamed sounds
+    /// keep it for the whole lifetime so that sources can refill from it
+    chunk_list data_;
+    /// data the static buffers read from directly. It must
+    /// outlive the buffer handles.
+    std::vector<std::vector<std::uint8_t>> static_data_;
+    /// upload in progress on the upload thread
+    std::shared_ptr<upload_ticket> upload_;
+    /// encoded data decoded by the streaming sources as they play
+    std::vector<std::uint8_t> encoded_;
+    sound_codec codec_{};
     /// the sound info
     sound_info info_;
     /// openal doesn't let us destroy sounds that are
     /// bound, so we have to keep this bookkeeping
     std::mutex mutex_;
     std::vector<source_impl*> bound_to_sources_;
+    std::vector<source_impl*> queued_on_sources_;
+    /// feed from a producer thread, if one was opened
+    std::unique_ptr<feed> feed_;
+    /// brings back the data once evicted
+    reload_recipe reload_;
+    /// the frames looped over, the whole sound while the end is 0
+    std::uint64_t loop_start_{};
+    std::uint64_t loop_end_{};
+    /// the loop points are set on the single buffer of a static sound
+    bool loop_points_applied_{};
+    /// bytes uploaded into the buffer handles
+    size_t uploaded_bytes_{};
+    /// the data and buffers were dropped to stay within the memory budget
+    bool evicted_{};
 
     bool stream_{};
 };
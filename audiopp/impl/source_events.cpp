@@ -0,0 +1,184 @@
+#include "source_events.h"
+#include "../source.h"
+#include "extensions.h"
+#include "source_impl.h"
+#include "source_registry.h"
+#include "spsc_queue.h"
+#include "voice_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace audio
+{
+namespace detail
+{
+namespace source_events
+{
+
+namespace
+{
+/// events the mixer may post between two updates before some are dropped
+constexpr size_t event_capacity = 1024;
+
+struct event
+{
+    ALenum type{};
+    ALuint source{};
+    ALuint param{};
+};
+
+struct state
+{
+    /// written by the event thread of openal, read by the update
+    spsc_queue<event> events{event_capacity};
+    /// the queue was full, some events got dropped
+    std::atomic<bool> lost{};
+    bool enabled{};
+
+    /// sources with notifications pending, nullptr once destroyed
+    std::vector<const source_impl*> pending;
+};
+
+auto get_state() -> state&
+{
+    static state s;
+    return s;
+}
+
+const std::array<ALenum, 2> event_types{{AL_EVENT_TYPE_SOURCE_STATE_CHANGED_SOFT,
+                                         AL_EVENT_TYPE_BUFFER_COMPLETED_SOFT}};
+
+void AL_APIENTRY on_event(ALenum type, ALuint object, ALuint param, ALsizei, const ALchar*, void*)
+{
+    auto& s = get_state();
+    if(!s.events.try_push({type, object, param}))
+    {
+        s.lost = true;
+    }
+}
+} // namespace
+
+void init()
+{
+    const auto& ext = get_extensions();
+    auto& s = get_state();
+    s.enabled = ext.events;
+    if(!s.enabled)
+    {
+        return;
+    }
+
+    ext.alEventCallbackSOFT(on_event, nullptr);
+    ext.alEventControlSOFT(ALsizei(event_types.size()), event_types.data(), AL_TRUE);
+}
+
+void shutdown()
+{
+    const auto& ext = get_extensions();
+    auto& s = get_state();
+    if(s.enabled)
+    {
+        ext.alEventControlSOFT(ALsizei(event_types.size()), event_types.data(), AL_FALSE);
+        ext.alEventCallbackSOFT(nullptr, nullptr);
+    }
+    s.enabled = false;
+
+    event e;
+    while(s.events.try_pop(e))
+    {
+    }
+    s.lost = false;
+}
+
+auto is_enabled() -> bool
+{
+    return get_state().enabled;
+}
+
+void poll()
+{
+    auto& s = get_state();
+
+    event e;
+    while(s.events.try_pop(e))
+    {
+        // drained before the voice pool hands a voice to another source, so
+        // the events go to the source which had the voice when they were
+        // posted. Ones still on their way then reach the next owner, where a
+        // state change is checked against the actual state anyway.
+        auto impl = voice_pool::find(e.source);
+        if(impl == nullptr)
+        {
+            continue;
+        }
+
+        if(e.type == AL_EVENT_TYPE_BUFFER_COMPLETED_SOFT)
+        {
+            impl->on_buffers_completed(e.param);
+        }
+        else if(ALint(e.param) == AL_STOPPED)
+        {
+            impl->refresh_state();
+        }
+    }
+
+    if(s.lost.exchange(false))
+    {
+        voice_pool::refresh_states();
+    }
+}
+
+void post(const source_impl* impl)
+{
+    get_state().pending.push_back(impl);
+}
+
+void forget(const source_impl* impl)
+{
+    auto& pending = get_state().pending;
+    std::replace(std::begin(pending), std::end(pending), impl, static_cast<const source_impl*>(nullptr));
+}
+
+void dispatch()
+{
+    auto& s = get_state();
+
+    // indexed, since the callbacks may post more or destroy sources
+    for(size_t i = 0; i < s.pending.size(); ++i)
+    {
+        auto impl = s.pending[i];
+        if(impl == nullptr)
+        {
+            continue;
+        }
+
+        auto notified = impl->take_notifications();
+        if(notified.buffers_completed > 0)
+        {
+            auto owner = source_registry::get_owner(impl);
+            auto callback = impl->get_on_buffer_completed();
+            if(owner && callback)
+            {
+                callback(*owner, notified.buffers_completed);
+            }
+        }
+
+        if(notified.stopped && s.pending[i] != nullptr)
+        {
+            auto owner = source_registry::get_owner(impl);
+            auto callback = impl->get_on_stopped();
+            if(owner && callback)
+            {
+                callback(*owner);
+            }
+        }
+    }
+    s.pending.clear();
+}
+
+} // namespace source_events
+} // namespace detail
+} // namespace audio
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <al.h>
+
+namespace audio
+{
+namespace detail
+{
+class source_impl;
+
+//-----------------------------------------------------------------------------
+/// Notifications for the source callbacks. The state changes and completed
+/// buffers of the real voices are pushed by the mixer when AL_SOFT_events is
+/// supported, otherwise they are noticed while polling.
+//-----------------------------------------------------------------------------
+namespace source_events
+{
+/// subscribes to the mixer events if possible
+void init();
+void shutdown();
+/// the real voices don't have to be polled for their state
+auto is_enabled() -> bool;
+
+/// applies the events the mixer posted since the last call
+void poll();
+
+/// the source has notifications pending for its callbacks
+void post(const source_impl* impl);
+void forget(const source_impl* impl);
+/// invokes the callbacks of the sources with notifications pending
+void dispatch();
+} // namespace source_events
+
+} // namespace detail
+} // namespace audio
@@ -1,8 +1,21 @@
 #include "source_impl.h"
 
-#include "../exception.h"
+#include "../logger.h"
+#include "bus_impl.h"
 #include "check.h"
+#include "extensions.h"
+#include "filter_pool.h"
 #include "sound_impl.h"
+#include "source_events.h"
+#include "source_registry.h"
+#include "update_batch.h"
+#include "voice_pool.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
 
 namespace audio
 {
@@ -10,34 +23,53 @@ namespace detail
 {
 namespace
 {
-int count = 0;
+/// number of buffers in the ring of a streaming source
+constexpr size_t stream_buffer_count = 4;
+/// smallest amount of audio worth to be uploaded at once
+constexpr duration_t stream_min_chunk_duration = duration_t(0.01);
+/// how far the lead time is allowed to grow because of underruns
+constexpr double stream_max_lead_time_scale = 4.0;
 }
 
 source_impl::source_impl()
 {
-    al_check(alGenSources(1, &handle_));
-
-    if(!is_valid())
-    {
-		throw audio::exception("Cannot create source. Max Sources reached " + std::to_string(count));
-    }
-
-    al_check(alSourcei(handle_, AL_SOURCE_RELATIVE, AL_FALSE));
-
-	count++;
+    // without a free real voice the source starts as a virtual one
+    virtual_clock_ = voice_pool::get_clock();
+    voice_pool::add(this);
+    source_registry::add(this);
 }
 
 source_impl::~source_impl()
 {
-    if(!is_valid())
+    source_registry::remove(this);
+    voice_pool::remove(this);
+
+    // also once the notifications were taken, since the
+    // source may be destroyed by a callback during the dispatch
+    source_events::forget(this);
+
+    if(bus_ != nullptr)
     {
-        return;
+        bus_->remove(this);
+    }
+
+    if(dirty_ != 0)
+    {
+        update_batch::forget(this);
     }
 
     unbind();
 
-    al_check(alDeleteSources(1, &handle_));
-	count--;
+    if(handle_ != 0)
+    {
+        clear_filters();
+        voice_pool::release(handle_);
+    }
+
+    if(!stream_buffers_.empty())
+    {
+        al_check(alDeleteBuffers(ALsizei(stream_buffers_.size()), stream_buffers_.data()));
+    }
 }
 
 auto source_impl::bind(sound_impl* sound) -> bool
@@ -64,288 +96,1308 @@ void source_impl::unbind()
     unbind_sound();
 }
 
-void source_impl::set_playback_position(float seconds)
+auto source_impl::queue_sound(sound_impl* sound) -> bool
 {
-    if(bound_sound_)
+    if(!bound_sound_ || !sound)
     {
-        auto duration = duration_t(seconds);
-        auto extra_duration = duration_t(1.0f);
-        auto required_size = bound_sound_->get_byte_size_for(duration + extra_duration);
-        bound_sound_->upload_until(required_size);
+        return false;
     }
 
-    al_check(alSourcef(handle_, AL_SEC_OFFSET, seconds));
-}
+    const auto& last = next_sounds_.empty() ? *bound_sound_ : *next_sounds_.back();
+    if(!sound->can_follow(last))
+    {
+        error() << "Sound " << sound->get_info().id << " can't be queued after sound " << last.get_info().id
+                << ", their formats differ";
+        return false;
+    }
 
-auto source_impl::get_volume() const -> float
-{
-    if(muted_)
+    sound->queue_on_source(this);
+    next_sounds_.push_back(sound);
+
+    // opened ahead, so that moving on to it costs nothing
+    if(is_streaming() && !next_stream_cursor_ && next_sounds_.size() == stream_sound_index_ + 1)
     {
-        return muted_volume_;
+        next_stream_cursor_ = sound->create_stream_cursor();
     }
 
-    ALfloat gain = 0.f;
-    al_check(alGetSourcef(handle_, AL_GAIN, &gain));
-    return gain;
+    chain_next_sound();
+    return true;
 }
 
-auto source_impl::get_pitch() const -> float
+void source_impl::clear_queued_sounds()
 {
-    ALfloat pitch = 0.f;
-    al_check(alGetSourcef(handle_, AL_PITCH, &pitch));
-    return pitch;
+    for(auto sound : next_sounds_)
+    {
+        sound->unqueue_from_source(this);
+    }
+    next_sounds_.clear();
+    next_stream_cursor_.reset();
+
+    unchain_sounds();
 }
 
-auto source_impl::get_playback_position() const -> float
+auto source_impl::get_queued_sound_count() const -> size_t
 {
-    ALfloat seconds = 0.0f;
-    al_check(alGetSourcef(handle_, AL_SEC_OFFSET, &seconds));
-    return static_cast<float>(seconds);
+    return next_sounds_.size();
 }
 
-auto source_impl::get_playback_duration() const -> float
+void source_impl::forget_queued_sound(sound_impl* sound)
 {
-    if(bound_sound_)
+    auto it = std::find(std::begin(next_sounds_), std::end(next_sounds_), sound);
+    if(it == std::end(next_sounds_))
     {
-        return float(bound_sound_->get_info().duration.count());
+        return;
     }
-    return 0.0f;
-}
 
-void source_impl::play() const
-{
-    al_check(alSourcePlay(handle_));
-}
+    auto index = size_t(std::distance(std::begin(next_sounds_), it));
+    next_sounds_.erase(it);
 
-void source_impl::stop() const
-{
-    set_loop(false);
-    al_check(alSourceStop(handle_));
-}
+    // its data or buffers may be in use already
+    if(index < stream_sound_index_ || (index == 0 && chained_after_ != 0))
+    {
+        unchain_sounds();
+        return;
+    }
 
-void source_impl::pause() const
-{
-    al_check(alSourcePause(handle_));
+    if(index == stream_sound_index_)
+    {
+        // the cursor opened ahead reads from it
+        next_stream_cursor_.reset();
+        if(is_streaming() && index < next_sounds_.size())
+        {
+            next_stream_cursor_ = next_sounds_[index]->create_stream_cursor();
+        }
+    }
 }
 
-auto source_impl::is_playing() const -> bool
+void source_impl::advance_queue()
 {
-    ALint state = AL_INITIAL;
-    al_check(alGetSourcei(handle_, AL_SOURCE_STATE, &state));
-    return (state == AL_PLAYING);
-}
+    auto next = next_sounds_.front();
+    next_sounds_.erase(std::begin(next_sounds_));
+    next->unqueue_from_source(this);
 
-auto source_impl::is_paused() const -> bool
-{
-    ALint state = AL_INITIAL;
-    al_check(alGetSourcei(handle_, AL_SOURCE_STATE, &state));
-    return (state == AL_PAUSED);
-}
+    bound_sound_->unbind_from_source(this);
+    bound_sound_ = next;
+    bound_sound_->bind_to_source(this);
 
-auto source_impl::is_stopped() const -> bool
-{
-    ALint state = AL_INITIAL;
-    al_check(alGetSourcei(handle_, AL_SOURCE_STATE, &state));
-    return (state == AL_STOPPED);
-}
+    chained_after_ = 0;
+    offset_stale_ = handle_ != 0;
 
-void source_impl::mute() const
-{
-    if(is_muted())
+    if(stream_sound_index_ > 0)
     {
+        stream_sound_index_--;
         return;
     }
-    muted_volume_ = get_volume();
-    set_volume(0.0f);
-    muted_ = true;
+
+    // the stream didn't get to read the next sound, the cursor opened ahead is the right one now
+    stream_cursor_ = std::move(next_stream_cursor_);
+    if(is_streaming() && !next_sounds_.empty())
+    {
+        next_stream_cursor_ = next_sounds_.front()->create_stream_cursor();
+    }
 }
 
-void source_impl::unmute() const
+void source_impl::chain_next_sound()
 {
-    if(!is_muted())
+    if(handle_ == 0 || looping_ || chained_after_ != 0 || next_sounds_.empty() || is_streaming())
     {
         return;
     }
-    muted_ = false;
-    set_volume(muted_volume_);
-}
 
-auto source_impl::is_muted() const -> bool
-{
-    return muted_;
-}
+    // a stopped source reports all of its buffers processed, the new ones too
+    if(cached_state_ == AL_STOPPED)
+    {
+        return;
+    }
 
-void source_impl::set_loop(bool on) const
-{
-    al_check(alSourcei(handle_, AL_LOOPING, on ? AL_TRUE : AL_FALSE));
+    auto next = next_sounds_.front();
+    if(!bound_sound_->is_uploaded() || !next->is_uploaded())
+    {
+        return;
+    }
+
+    // openal plays through the queue without a gap
+    chained_after_ = bound_sound_->native_handles().size();
+    const auto& handles = next->native_handles();
+    enqueue_buffers(handles.data(), handles.size());
 }
 
-void source_impl::set_volume(float volume) const
+void source_impl::update_queue()
 {
-    if(muted_)
+    if(!bound_sound_->is_streaming())
     {
-        muted_volume_ = volume;
+        // uploaded ahead, off the context thread when big enough
+        next_sounds_.front()->upload_chunk();
     }
-    else
+
+    if(handle_ == 0)
     {
-        al_check(alSourcef(handle_, AL_GAIN, volume));
+        // the virtual voice moves on once past the end of the bound sound
+        sync_virtual();
+        auto duration = get_playback_duration();
+        while(!next_sounds_.empty() && cached_state_ == AL_PLAYING && duration > 0.0f &&
+              cached_offset_ >= duration)
+        {
+            cached_offset_ -= duration;
+            advance_queue();
+            duration = get_playback_duration();
+        }
+        return;
     }
-}
 
-/* pitch, speed stretching */
-void source_impl::set_pitch(float pitch) const
-{
-    // if pitch == 0.f pitch = 0.0001f;
-    al_check(alSourcef(handle_, AL_PITCH, pitch));
-}
+    if(is_streaming())
+    {
+        // the stream moves on once the chunks of the bound sound are played
+        while(!next_sounds_.empty() && !queued_stream_chunks_.empty() &&
+              queued_stream_chunks_.front().sound != bound_sound_)
+        {
+            advance_queue();
+        }
+        return;
+    }
 
-void source_impl::set_position(const float3& position) const
-{
-    al_check(alSourcefv(handle_, AL_POSITION, position.data()));
-}
+    chain_next_sound();
+    if(chained_after_ == 0)
+    {
+        return;
+    }
 
-void source_impl::set_velocity(const float3& velocity) const
-{
-    al_check(alSourcefv(handle_, AL_VELOCITY, velocity.data()));
-}
+    ALint processed = 0;
+    al_check(alGetSourcei(handle_, AL_BUFFERS_PROCESSED, &processed));
+    if(size_t(processed) < chained_after_)
+    {
+        return;
+    }
 
-void source_impl::set_orientation(const float3& direction, const float3& up) const
-{
-    float orientation6[] = {-direction[0], -direction[1], -direction[2], up[0], up[1], up[2]};
-    al_check(alSourcefv(handle_, AL_ORIENTATION, orientation6));
+    // once per sound played through, stopping on request unchains
+    refresh_state();
+    if(cached_state_ == AL_STOPPED)
+    {
+        // the chained sound played through before this update as well
+        advance_queue();
+        requeue_bound_sound();
+        if(!next_sounds_.empty())
+        {
+            // too short to be chained in time, the rest follows after a gap
+            advance_queue();
+            requeue_bound_sound();
+            play();
+        }
+        return;
+    }
+
+    // the bound sound was played, only the next one is left in the queue
+    unqueued_buffers_.resize(chained_after_);
+    al_check(alSourceUnqueueBuffers(handle_, ALsizei(unqueued_buffers_.size()), unqueued_buffers_.data()));
+    advance_queue();
+    chain_next_sound();
 }
 
-void source_impl::set_volume_rolloff(float rolloff) const
+void source_impl::requeue_bound_sound()
 {
-    al_check(alSourcef(handle_, AL_ROLLOFF_FACTOR, rolloff));
+    // only the buffers of a stopped source can be swapped
+    al_check(alSourcei(handle_, AL_BUFFER, 0));
+    chained_after_ = 0;
+    const auto& handles = bound_sound_->native_handles();
+    enqueue_buffers(handles.data(), handles.size());
 }
 
-void source_impl::set_distance(float mind, float maxd) const
+void source_impl::unchain_sounds()
 {
+    if(handle_ == 0)
+    {
+        // nothing is queued, the stream is read again once promoted
+        reset_stream_sound();
+        return;
+    }
 
-    // The distance that the source will be the loudest (if the listener is
-    // closer, it won't be any louder than if they were at this distance)
-    al_check(alSourcef(handle_, AL_REFERENCE_DISTANCE, mind));
+    if(chained_after_ == 0 && stream_sound_index_ == 0)
+    {
+        return;
+    }
 
-    // The distance that the source will be the quietest (if the listener is
-    // farther, it won't be any quieter than if they were at this distance)
-    al_check(alSourcef(handle_, AL_MAX_DISTANCE, maxd));
-}
+    refresh_state();
+    auto state = cached_state_;
+    auto offset = get_playback_position();
 
-auto source_impl::is_valid() const -> bool
-{
-    return handle_ != 0;
+    if(is_streaming())
+    {
+        restart_stream(bound_sound_->get_byte_size_for(duration_t(offset)));
+    }
+    else
+    {
+        // pending buffers can't be unqueued, queue the bound ones alone again
+        al_check(alSourceRewind(handle_));
+        requeue_bound_sound();
+        al_check(alSourcef(handle_, AL_SEC_OFFSET, offset));
+        cached_state_ = AL_INITIAL;
+    }
+
+    if(state == AL_PLAYING || state == AL_PAUSED)
+    {
+        play();
+    }
+    if(state == AL_PAUSED)
+    {
+        pause();
+    }
 }
 
-auto source_impl::is_looping() const -> bool
+void source_impl::set_playback_position(float seconds)
 {
-    ALint loop;
-    al_check(alGetSourcei(handle_, AL_LOOPING, &loop));
-    return loop != 0;
+    if(handle_ == 0)
+    {
+        sync_virtual();
+        cached_offset_ = seconds;
+        return;
+    }
+
+    if(is_streaming())
+    {
+        auto state = query_state();
+        auto was_playing = state == AL_PLAYING;
+        auto was_paused = state == AL_PAUSED;
+
+        // the ring only holds what is around the playback position,
+        // so start streaming over from the requested offset
+        restart_stream(bound_sound_->get_byte_size_for(duration_t(seconds)));
+
+        if(was_playing || was_paused)
+        {
+            play();
+        }
+        if(was_paused)
+        {
+            pause();
+        }
+        return;
+    }
+
+    al_check(alSourcef(handle_, AL_SEC_OFFSET, seconds));
+    refresh_state();
 }
 
-auto source_impl::update_stream() -> bool
+auto source_impl::get_volume() const -> float
 {
-    if(bound_sound_)
+    if(muted_)
     {
-        return bound_sound_->upload_chunk();
+        return muted_volume_;
     }
 
-    return false;
+    return volume_;
 }
 
-auto source_impl::native_handle() const -> native_handle_type
+auto source_impl::get_pitch() const -> float
 {
-    return handle_;
+    return pitch_;
 }
 
-auto source_impl::get_bound_sound_uid() const -> uintptr_t
+auto source_impl::get_playback_position() const -> float
 {
-    return reinterpret_cast<uintptr_t>(bound_sound_);
+    sync_virtual();
+    if(offset_stale_ && handle_ != 0)
+    {
+        al_check(alGetSourcef(handle_, AL_SEC_OFFSET, &cached_offset_));
+    }
+    offset_stale_ = false;
+    auto seconds = cached_offset_;
+
+    if(is_streaming() && !queued_stream_chunks_.empty())
+    {
+        // the offset is relative to the first queued buffer
+        const auto& info = bound_sound_->get_info();
+        auto frame = queued_stream_chunks_.front().offset / bound_sound_->get_frame_size();
+        seconds += float(double(frame) / double(info.sample_rate));
+    }
+
+    return seconds;
 }
 
-auto source_impl::get_bound_sound_info() const -> const sound_info&
+auto source_impl::get_playback_position_precise() const -> playback_position
 {
+    playback_position result{};
     if(!bound_sound_)
     {
-        static const sound_info empty{};
-        return empty;
+        return result;
     }
 
-    return bound_sound_->get_info();
-}
+    const auto& info = bound_sound_->get_info();
+    result.sample_rate = info.sample_rate;
 
-void source_impl::enqueue_buffers(const native_handle_type* handles, size_t count) const
-{
-    al_check(alSourceQueueBuffers(handle_, ALsizei(count), handles));
+    if(handle_ == 0)
+    {
+        // only the time of the virtual voice is known, nothing is mixed
+        sync_virtual();
+        result.frames = std::int64_t(double(cached_offset_) * double(info.sample_rate) * 4294967296.0);
+        return result;
+    }
+
+    const auto& ext = get_extensions();
+    if(ext.source_latency)
+    {
+        std::int64_t values[2]{};
+        al_check(ext.alGetSourcei64vSOFT(handle_, AL_SAMPLE_OFFSET_LATENCY_SOFT, values));
+        result.frames = values[0];
+        result.latency = std::chrono::nanoseconds(values[1]);
+
+        if(ext.device_clock)
+        {
+            // the offset is taken again along with the clock, so that
+            // both come from the same instant
+            al_check(ext.alGetSourcei64vSOFT(handle_, AL_SAMPLE_OFFSET_CLOCK_SOFT, values));
+            result.frames = values[0];
+            result.device_time = std::chrono::nanoseconds(values[1]);
+        }
+    }
+    else
+    {
+        // whole frames at least, unlike the float seconds
+        ALint frame = 0;
+        al_check(alGetSourcei(handle_, AL_SAMPLE_OFFSET, &frame));
+        result.frames = std::int64_t(frame) << 32;
+
+        if(ext.device_clock)
+        {
+            std::int64_t clock = 0;
+            auto device = alcGetContextsDevice(alcGetCurrentContext());
+            ext.alcGetInteger64vSOFT(device, ALC_DEVICE_CLOCK_SOFT, 1, &clock);
+            result.device_time = std::chrono::nanoseconds(clock);
+        }
+    }
+
+    if(is_streaming() && !queued_stream_chunks_.empty())
+    {
+        // the offset is relative to the first queued buffer,
+        // the ones before it were played and unqueued already
+        auto frame = queued_stream_chunks_.front().offset / bound_sound_->get_frame_size();
+        result.frames += std::int64_t(frame) << 32;
+    }
+
+    return result;
 }
 
-void source_impl::unqueue_buffers() const
+auto source_impl::get_playback_duration() const -> float
 {
-    al_check(alSourcei(handle_, AL_BUFFER, 0));
+    if(bound_sound_)
+    {
+        return float(bound_sound_->get_info().duration.count());
+    }
+    return 0.0f;
 }
 
-auto source_impl::get_queued_buffers() const -> size_t
+void source_impl::play()
 {
-    ALint queued = 0;
-    al_check(alGetSourcei(handle_, AL_BUFFERS_QUEUED, &queued));
-    return static_cast<size_t>(queued);
+    if(prepare_play())
+    {
+        al_check(alSourcePlay(handle_));
+        refresh_state();
+    }
 }
 
-void source_impl::bind_sound(sound_impl* sound)
+void source_impl::play_together(const std::vector<source_impl*>& sources, duration_t delay)
 {
-    if(bound_sound_ == sound)
+    // reused, the group is started once per frame at most
+    static std::vector<native_handle_type> handles;
+    handles.clear();
+
+    for(auto source : sources)
     {
-        return;
+        // the ones without buffers yet start on their own once uploaded,
+        // played now openal would stop them right away
+        if(source->prepare_play() && !source->play_pending_)
+        {
+            handles.push_back(source->handle_);
+        }
     }
 
-    bound_sound_ = sound;
-    bound_sound_->bind_to_source(this);
+    if(handles.empty())
+    {
+        return;
+    }
 
-    // if we already have some created handles
-    // then just queue them, otherwise update the stream
-    const auto& handles = bound_sound_->native_handles();
-    if(!handles.empty())
+    const auto& ext = get_extensions();
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count();
+    if(nanoseconds > 0 && ext.source_start_delay && ext.device_clock)
     {
-        enqueue_buffers(handles.data(), handles.size());
+        std::int64_t clock = 0;
+        auto device = alcGetContextsDevice(alcGetCurrentContext());
+        ext.alcGetInteger64vSOFT(device, ALC_DEVICE_CLOCK_SOFT, 1, &clock);
+        al_check(ext.alSourcePlayAtTimevSOFT(ALsizei(handles.size()), handles.data(), clock + nanoseconds));
     }
     else
     {
-        update_stream();
+        al_check(alSourcePlayv(ALsizei(handles.size()), handles.data()));
+    }
+
+    for(auto source : sources)
+    {
+        if(source->handle_ != 0)
+        {
+            source->refresh_state();
+        }
     }
 }
 
-void source_impl::unbind_sound()
+auto source_impl::prepare_play() -> bool
 {
-    auto queued_buffers = get_queued_buffers();
+    // played on request, a bus resuming later must not restart it
+    paused_by_bus_ = false;
 
-    if(queued_buffers != 0)
+    if(handle_ == 0)
     {
-        stop();
-        unqueue_buffers();
+        // replays like a real voice would and takes one if any is free
+        sync_virtual();
+        if(cached_state_ == AL_PLAYING || cached_state_ == AL_STOPPED)
+        {
+            cached_offset_ = 0.0f;
+        }
+        cached_state_ = AL_PLAYING;
+        drop_stopped_notification();
+
+        voice_pool::try_promote(this);
+        return false;
     }
 
-    if(bound_sound_ != nullptr)
+    drop_stopped_notification();
+
+    if(is_streaming() && !stream_primed_ && !stream_starved_ && query_state() == AL_STOPPED)
     {
-        bound_sound_->unbind_from_source(this);
-        bound_sound_ = nullptr;
+        // the stream was either played through or stopped
+        // so start it over like a static buffer would
+        restart_stream(0);
     }
+    stream_primed_ = false;
+    stream_playing_ = true;
+
+    // a source without buffers stops right away,
+    // so play once the upload thread is done
+    play_pending_ = bound_sound_ && !is_streaming() && get_queued_buffers() == 0;
+    return true;
 }
 
-auto source_impl::bind_source_aux_slot_to_effect(builtin_effect_impl* effect) -> bool
+void source_impl::stop()
 {
-    if (!effect)
+    set_loop(false);
+    paused_by_bus_ = false;
+    if(handle_ != 0)
     {
-        return true;
+        // stopped on request, not played through
+        cached_state_ = AL_STOPPED;
+        al_check(alSourceStop(handle_));
+        refresh_state();
+
+        // played from the start of the bound sound again, chained anew
+        if(chained_after_ != 0)
+        {
+            requeue_bound_sound();
+        }
     }
-
-    if (effect_to_slot_.find(effect) != effect_to_slot_.end())
+    else
+    {
+        sync_virtual();
+        cached_state_ = AL_STOPPED;
+        cached_offset_ = 0.0f;
+    }
+    play_pending_ = false;
+    stream_primed_ = false;
+    stream_playing_ = false;
+    stream_starved_ = false;
+}
+
+void source_impl::pause()
+{
+    if(prepare_pause())
+    {
+        al_check(alSourcePause(handle_));
+        refresh_state();
+    }
+}
+
+void source_impl::pause_together(const std::vector<source_impl*>& sources)
+{
+    // reused, no allocations once grown
+    static std::vector<native_handle_type> handles;
+    handles.clear();
+
+    for(auto source : sources)
+    {
+        if(source->prepare_pause())
+        {
+            handles.push_back(source->handle_);
+        }
+    }
+
+    if(handles.empty())
+    {
+        return;
+    }
+
+    al_check(alSourcePausev(ALsizei(handles.size()), handles.data()));
+
+    for(auto source : sources)
+    {
+        source->refresh_state();
+    }
+}
+
+auto source_impl::prepare_pause() -> bool
+{
+    play_pending_ = false;
+    if(handle_ != 0)
+    {
+        return true;
+    }
+
+    sync_virtual();
+    if(cached_state_ == AL_PLAYING)
+    {
+        cached_state_ = AL_PAUSED;
+    }
+    return false;
+}
+
+auto source_impl::is_playing() const -> bool
+{
+    sync_virtual();
+    return cached_state_ == AL_PLAYING;
+}
+
+auto source_impl::is_paused() const -> bool
+{
+    sync_virtual();
+    return cached_state_ == AL_PAUSED;
+}
+
+auto source_impl::is_stopped() const -> bool
+{
+    sync_virtual();
+    return cached_state_ == AL_STOPPED;
+}
+
+void source_impl::refresh_state() const
+{
+    if(handle_ == 0)
+    {
+        return;
+    }
+
+    auto previous = cached_state_;
+    al_check(alGetSourcei(handle_, AL_SOURCE_STATE, &cached_state_));
+    al_check(alGetSourcef(handle_, AL_SEC_OFFSET, &cached_offset_));
+    offset_stale_ = false;
+
+    // a stream stops whenever it runs dry, update_stream knows when it is over
+    if(previous == AL_PLAYING && cached_state_ == AL_STOPPED && !is_streaming())
+    {
+        finished();
+    }
+}
+
+auto source_impl::query_state() const -> ALint
+{
+    if(handle_ == 0)
+    {
+        sync_virtual();
+        return cached_state_;
+    }
+
+    ALint state = AL_INITIAL;
+    al_check(alGetSourcei(handle_, AL_SOURCE_STATE, &state));
+    return state;
+}
+
+void source_impl::mute() const
+{
+    if(is_muted())
+    {
+        return;
+    }
+    muted_volume_ = get_volume();
+    set_volume(0.0f);
+    muted_ = true;
+}
+
+void source_impl::unmute() const
+{
+    if(!is_muted())
+    {
+        return;
+    }
+    muted_ = false;
+    set_volume(muted_volume_);
+}
+
+auto source_impl::is_muted() const -> bool
+{
+    return muted_;
+}
+
+void source_impl::set_loop(bool on)
+{
+    sync_virtual();
+    looping_ = on;
+
+    // after looping is on, so that the bound sound isn't chained
+    // or streamed into the next one again when requeued
+    if(on && (chained_after_ != 0 || stream_sound_index_ != 0))
+    {
+        // openal would loop the queued sound along with the bound one,
+        // a stream would wrap around into the next sound read already
+        unchain_sounds();
+    }
+
+    if(handle_ == 0)
+    {
+        return;
+    }
+
+    // streamed sounds are looped by wrapping the stream around,
+    // looping the queue would just repeat the buffers in the ring
+    al_check(alSourcei(handle_, AL_LOOPING, (looping_ && !is_streaming()) ? AL_TRUE : AL_FALSE));
+}
+
+void source_impl::set_volume(float volume) const
+{
+    if(muted_)
+    {
+        muted_volume_ = volume;
+    }
+    else
+    {
+        volume_ = volume;
+        if(handle_ != 0 && !defer(dirty_gain))
+        {
+            al_check(alSourcef(handle_, AL_GAIN, get_gain()));
+        }
+    }
+}
+
+/* pitch, speed stretching */
+void source_impl::set_pitch(float pitch) const
+{
+    // if pitch == 0.f pitch = 0.0001f;
+    sync_virtual();
+    pitch_ = pitch;
+    if(handle_ != 0 && !defer(dirty_pitch))
+    {
+        al_check(alSourcef(handle_, AL_PITCH, get_effective_pitch()));
+    }
+}
+
+void source_impl::set_position(const float3& position) const
+{
+    position_ = position;
+    voice_pool::relocate(this);
+    if(handle_ != 0 && !defer(dirty_position))
+    {
+        al_check(alSourcefv(handle_, AL_POSITION, position.data()));
+    }
+}
+
+void source_impl::set_velocity(const float3& velocity) const
+{
+    velocity_ = velocity;
+    if(handle_ != 0 && !defer(dirty_velocity))
+    {
+        al_check(alSourcefv(handle_, AL_VELOCITY, velocity.data()));
+    }
+}
+
+void source_impl::set_orientation(const float3& direction, const float3& up) const
+{
+    orientation_ = {{-direction[0], -direction[1], -direction[2], up[0], up[1], up[2]}};
+    if(handle_ != 0 && !defer(dirty_orientation))
+    {
+        al_check(alSourcefv(handle_, AL_ORIENTATION, orientation_.data()));
+    }
+}
+
+auto source_impl::defer(std::uint8_t property) const -> bool
+{
+    if(!update_batch::is_active())
+    {
+        return false;
+    }
+
+    if(dirty_ == 0)
+    {
+        update_batch::mark_dirty(this);
+    }
+    dirty_ |= property;
+    return true;
+}
+
+void source_impl::flush_properties() const
+{
+    if(handle_ == 0)
+    {
+        // everything is applied once a real voice is taken
+        dirty_ = 0;
+        return;
+    }
+
+    if(dirty_ & dirty_gain)
+    {
+        al_check(alSourcef(handle_, AL_GAIN, get_gain()));
+    }
+    if(dirty_ & dirty_pitch)
+    {
+        al_check(alSourcef(handle_, AL_PITCH, get_effective_pitch()));
+    }
+    if(dirty_ & dirty_position)
+    {
+        al_check(alSourcefv(handle_, AL_POSITION, position_.data()));
+    }
+    if(dirty_ & dirty_velocity)
+    {
+        al_check(alSourcefv(handle_, AL_VELOCITY, velocity_.data()));
+    }
+    if(dirty_ & dirty_filter)
+    {
+        apply_direct_filter();
+    }
+    if(dirty_ & dirty_orientation)
+    {
+        al_check(alSourcefv(handle_, AL_ORIENTATION, orientation_.data()));
+    }
+    dirty_ = 0;
+}
+
+void source_impl::set_volume_rolloff(float rolloff) const
+{
+    rolloff_ = rolloff;
+    voice_pool::relocate(this);
+    if(handle_ == 0)
+    {
+        return;
+    }
+
+    al_check(alSourcef(handle_, AL_ROLLOFF_FACTOR, rolloff));
+}
+
+void source_impl::set_distance(float mind, float maxd) const
+{
+    reference_distance_ = mind;
+    max_distance_ = maxd;
+    voice_pool::relocate(this);
+    if(handle_ == 0)
+    {
+        return;
+    }
+
+    // The distance that the source will be the loudest (if the listener is
+    // closer, it won't be any louder than if they were at this distance)
+    al_check(alSourcef(handle_, AL_REFERENCE_DISTANCE, mind));
+
+    // The distance that the source will be the quietest (if the listener is
+    // farther, it won't be any quieter than if they were at this distance)
+    al_check(alSourcef(handle_, AL_MAX_DISTANCE, maxd));
+}
+
+void source_impl::set_direct_filter(const filter& params) const
+{
+    if(params == direct_filter_)
+    {
+        return;
+    }
+
+    direct_filter_ = params;
+    if(handle_ != 0 && !defer(dirty_filter))
+    {
+        apply_direct_filter();
+    }
+}
+
+auto source_impl::get_direct_filter() const -> const filter&
+{
+    return direct_filter_;
+}
+
+auto source_impl::is_valid() const -> bool
+{
+    // virtual sources are fully functional too
+    return true;
+}
+
+auto source_impl::is_looping() const -> bool
+{
+    return looping_;
+}
+
+auto source_impl::update_stream() -> bool
+{
+    if(!bound_sound_)
+    {
+        return false;
+    }
+
+    if(!bound_sound_->is_streaming())
+    {
+        auto uploaded = bound_sound_->upload_chunk();
+        if(!next_sounds_.empty())
+        {
+            update_queue();
+        }
+        return uploaded;
+    }
+
+    if(handle_ == 0)
+    {
+        // nothing is queued, only keep taking what the producer feeds
+        bound_sound_->is_waiting_for_data();
+        if(!next_sounds_.empty())
+        {
+            update_queue();
+        }
+        return false;
+    }
+
+    // nothing gets processed unless the stream is being played
+    if(!stream_playing_)
+    {
+        return false;
+    }
+
+    // reclaim the buffers the source is done with
+    ALint processed = 0;
+    al_check(alGetSourcei(handle_, AL_BUFFERS_PROCESSED, &processed));
+    processed = std::min(processed, ALint(queued_stream_chunks_.size()));
+
+    if(processed > 0)
+    {
+        std::array<native_handle_type, stream_buffer_count> buffers{};
+        al_check(alSourceUnqueueBuffers(handle_, processed, buffers.data()));
+
+        free_stream_buffers_.insert(std::end(free_stream_buffers_), std::begin(buffers),
+                                    std::begin(buffers) + processed);
+        queued_stream_chunks_.erase(std::begin(queued_stream_chunks_),
+                                    std::begin(queued_stream_chunks_) + processed);
+
+        if(!source_events::is_enabled())
+        {
+            notify(size_t(processed), false);
+        }
+
+        if(!next_sounds_.empty())
+        {
+            update_queue();
+        }
+    }
+
+    // when the whole queue is processed the source has stopped.
+    // Keep checking a starved stream since more data may be fed meanwhile.
+    bool drained = queued_stream_chunks_.empty();
+    if(processed == 0 && !drained)
+    {
+        return false;
+    }
+
+    // takes whatever the producer has fed so far
+    bool waiting = get_stream_sound()->is_waiting_for_data();
+    auto queued = refill_stream();
+
+    if(drained && queued && !next_sounds_.empty())
+    {
+        // the ring ran dry right where the next sound starts
+        update_queue();
+    }
+
+    if(drained)
+    {
+        if(!queued)
+        {
+            if(!waiting)
+            {
+                // played through
+                stream_playing_ = false;
+                stream_starved_ = false;
+                finished();
+            }
+            else if(!stream_starved_)
+            {
+                // the producer didn't keep up, keep the source alive until it does
+                stream_starved_ = true;
+                bound_sound_->on_underrun();
+
+                trace() << "Stream for sound " << bound_sound_->get_info().id << " is waiting for data";
+            }
+        }
+        else if(query_state() == AL_STOPPED)
+        {
+            if(stream_starved_)
+            {
+                // the lead time is not to blame for a starving producer
+                stream_starved_ = false;
+            }
+            else
+            {
+                // we didn't keep up with the playback, so queue more ahead from now on
+                auto scaled = stream_adapted_lead_time_ * 1.5;
+                stream_adapted_lead_time_ = std::min(scaled, stream_lead_time_ * stream_max_lead_time_scale);
+                refill_stream();
+                bound_sound_->on_underrun();
+
+                trace() << "Stream underrun for sound " << bound_sound_->get_info().id
+                        << ". Lead time adapted to " << stream_adapted_lead_time_.count() << "s";
+            }
+
+            al_check(alSourcePlay(handle_));
+            refresh_state();
+        }
+    }
+
+    return queued;
+}
+
+auto source_impl::is_streaming() const -> bool
+{
+    return bound_sound_ && bound_sound_->is_streaming();
+}
+
+void source_impl::set_stream_lead_time(duration_t lead_time)
+{
+    stream_lead_time_ = std::max(lead_time, stream_min_chunk_duration);
+    stream_adapted_lead_time_ = stream_lead_time_;
+}
+
+auto source_impl::get_stream_lead_time() const -> duration_t
+{
+    return stream_lead_time_;
+}
+
+auto source_impl::get_stream_offset() const -> size_t
+{
+    return stream_cursor_ ? stream_cursor_->tell() : 0;
+}
+
+auto source_impl::native_handle() const -> native_handle_type
+{
+    return handle_;
+}
+
+auto source_impl::get_bound_sound_uid() const -> uintptr_t
+{
+    return reinterpret_cast<uintptr_t>(bound_sound_);
+}
+
+auto source_impl::get_bound_sound_info() const -> const sound_info&
+{
+    if(!bound_sound_)
+    {
+        static const sound_info empty{};
+        return empty;
+    }
+
+    return bound_sound_->get_info();
+}
+
+void source_impl::enqueue_buffers(const native_handle_type* handles, size_t count) const
+{
+    if(handle_ == 0)
+    {
+        return;
+    }
+
+    al_check(alSourceQueueBuffers(handle_, ALsizei(count), handles));
+}
+
+void source_impl::unqueue_buffers() const
+{
+    if(handle_ == 0)
+    {
+        return;
+    }
+
+    al_check(alSourcei(handle_, AL_BUFFER, 0));
+}
+
+void source_impl::on_buffer_uploaded(native_handle_type handle)
+{
+    // all uploaded buffers are queued once a real voice is taken
+    if(handle_ == 0)
+    {
+        return;
+    }
+
+    enqueue_buffers(&handle, 1);
+
+    if(play_pending_)
+    {
+        play_pending_ = false;
+        al_check(alSourcePlay(handle_));
+        refresh_state();
+    }
+}
+
+auto source_impl::get_queued_buffers() const -> size_t
+{
+    if(handle_ == 0)
+    {
+        return 0;
+    }
+
+    ALint queued = 0;
+    al_check(alGetSourcei(handle_, AL_BUFFERS_QUEUED, &queued));
+    return static_cast<size_t>(queued);
+}
+
+void source_impl::bind_sound(sound_impl* sound)
+{
+    if(bound_sound_ == sound)
+    {
+        return;
+    }
+
+    bound_sound_ = sound;
+    bound_sound_->bind_to_source(this);
+    source_registry::set_bound(this, true);
+
+    // looping is handled differently for streamed sounds
+    set_loop(looping_);
+
+    if(bound_sound_->is_streaming())
+    {
+        restart_stream(0);
+        return;
+    }
+
+    // if we already have some created handles
+    // then just queue them, otherwise update the stream
+    const auto& handles = bound_sound_->native_handles();
+    if(!handles.empty())
+    {
+        enqueue_buffers(handles.data(), handles.size());
+    }
+    else
+    {
+        update_stream();
+    }
+}
+
+void source_impl::unbind_sound()
+{
+    auto queued_buffers = get_queued_buffers();
+
+    if(queued_buffers != 0 || (handle_ == 0 && bound_sound_ != nullptr))
+    {
+        stop();
+        unqueue_buffers();
+    }
+
+    if(bound_sound_ != nullptr)
+    {
+        bound_sound_->unbind_from_source(this);
+        bound_sound_ = nullptr;
+        source_registry::set_bound(this, false);
+    }
+
+    // all of the ring is unqueued now
+    free_stream_buffers_ = stream_buffers_;
+    queued_stream_chunks_.clear();
+    stream_cursor_.reset();
+    stream_primed_ = false;
+    stream_playing_ = false;
+    stream_starved_ = false;
+    play_pending_ = false;
+    paused_by_bus_ = false;
+
+    // nothing of the queued sounds is played anymore
+    chained_after_ = 0;
+    stream_sound_index_ = 0;
+    clear_queued_sounds();
+}
+
+void source_impl::reset_stream_sound()
+{
+    if(stream_sound_index_ == 0)
+    {
+        return;
+    }
+
+    // the stream read ahead into the queued sounds, read the bound one again
+    stream_cursor_.reset();
+    stream_sound_index_ = 0;
+    next_stream_cursor_.reset();
+    if(!next_sounds_.empty())
+    {
+        next_stream_cursor_ = next_sounds_.front()->create_stream_cursor();
+    }
+}
+
+void source_impl::restart_stream(size_t offset)
+{
+    reset_stream_sound();
+
+    if(handle_ == 0)
+    {
+        // only the position is tracked until a real voice is taken
+        sync_virtual();
+        const auto& info = bound_sound_->get_info();
+        auto frame = offset / bound_sound_->get_frame_size();
+        cached_state_ = AL_INITIAL;
+        cached_offset_ = float(double(frame) / double(info.sample_rate));
+        stream_primed_ = false;
+        stream_playing_ = false;
+        stream_starved_ = false;
+        return;
+    }
+
+    if(stream_buffers_.empty())
+    {
+        stream_buffers_.resize(stream_buffer_count);
+        al_check(alGenBuffers(ALsizei(stream_buffers_.size()), stream_buffers_.data()));
+    }
+
+    // drop everything queued so far. Rewinding
+    // puts the source back to its initial state.
+    al_check(alSourceRewind(handle_));
+    cached_state_ = AL_INITIAL;
+    cached_offset_ = 0.0f;
+    unqueue_buffers();
+
+    free_stream_buffers_ = stream_buffers_;
+    queued_stream_chunks_.clear();
+
+    // only the position changes, no data before it gets touched
+    if(!stream_cursor_)
+    {
+        stream_cursor_ = bound_sound_->create_stream_cursor();
+    }
+    stream_cursor_->seek(offset);
+
+    refill_stream();
+    stream_primed_ = true;
+    stream_playing_ = false;
+    stream_starved_ = false;
+}
+
+auto source_impl::get_stream_sound() const -> sound_impl*
+{
+    return stream_sound_index_ == 0 ? bound_sound_ : next_sounds_[stream_sound_index_ - 1];
+}
+
+auto source_impl::refill_stream() -> bool
+{
+    // the queued sounds share the format of the bound one
+    auto sound = get_stream_sound();
+
+    // takes what the producer fed so far, also before the first play
+    sound->pump_feed();
+
+    auto lead_size = sound->get_byte_size_for(stream_adapted_lead_time_);
+    auto min_chunk_size = std::max(sound->get_byte_size_for(stream_min_chunk_duration),
+                                   sound->get_frame_size());
+    auto frame_size = sound->get_frame_size();
+
+    // looping streams jump back to the loop start once at the loop end
+    auto begin = sound->get_stream_begin();
+    auto loop_begin = begin;
+    auto loop_end = std::numeric_limits<size_t>::max();
+    if(looping_ && sound->has_loop_points())
+    {
+        loop_begin = std::max(begin, size_t(sound->get_loop_start()) * frame_size);
+        if(sound->get_loop_end() != 0)
+        {
+            loop_end = size_t(sound->get_loop_end()) * frame_size;
+        }
+    }
+
+    bool queued = false;
+    while(!free_stream_buffers_.empty())
+    {
+        // top up only what is missing to the lead time
+        auto queued_size = get_queued_stream_size();
+        if(queued_size >= lead_size)
+        {
+            break;
+        }
+
+        // spread what is missing over the free buffers, so that
+        // chunks adapt to how fast the queue is being processed
+        auto chunk_size = (lead_size - queued_size) / free_stream_buffers_.size();
+        chunk_size = std::max(chunk_size - chunk_size % frame_size, min_chunk_size);
+
+        auto buffer = free_stream_buffers_.back();
+        auto offset = stream_cursor_->tell();
+        if(offset >= loop_end)
+        {
+            stream_cursor_->seek(loop_begin);
+            offset = stream_cursor_->tell();
+        }
+
+        // the chunk before the loop end stops exactly on it
+        chunk_size = std::min(chunk_size, loop_end - offset);
+        auto size = sound->stream_to(buffer, *stream_cursor_, chunk_size);
+
+        if(size == 0 && looping_ && offset != loop_begin)
+        {
+            // reached the end, wrap around
+            stream_cursor_->seek(loop_begin);
+            offset = stream_cursor_->tell();
+            size = sound->stream_to(buffer, *stream_cursor_, chunk_size);
+        }
+
+        if(size == 0 && !looping_ && stream_sound_index_ < next_sounds_.size() && !sound->is_waiting_for_data())
+        {
+            // reached the end, move on to the next sound in the same ring
+            sound = next_sounds_[stream_sound_index_++];
+            stream_cursor_ = next_stream_cursor_ ? std::move(next_stream_cursor_) : sound->create_stream_cursor();
+            stream_cursor_->seek(sound->get_stream_begin());
+            if(stream_sound_index_ < next_sounds_.size())
+            {
+                next_stream_cursor_ = next_sounds_[stream_sound_index_]->create_stream_cursor();
+            }
+
+            offset = stream_cursor_->tell();
+            size = sound->stream_to(buffer, *stream_cursor_, chunk_size);
+        }
+
+        if(size == 0)
+        {
+            break;
+        }
+
+        free_stream_buffers_.pop_back();
+        queued_stream_chunks_.push_back({offset, size, sound});
+
+        enqueue_buffers(&buffer, 1);
+        queued = true;
+    }
+
+    return queued;
+}
+
+auto source_impl::get_queued_stream_size() const -> size_t
+{
+    size_t size = 0;
+    for(const auto& chunk : queued_stream_chunks_)
+    {
+        size += chunk.size;
+    }
+    return size;
+}
+
+auto source_impl::bind_source_aux_slot_to_effect(builtin_effect_impl* effect) -> bool
+{
+    if (!effect)
+    {
+        return true;
+    }
+
+    if (effect_to_slot_.find(effect) != effect_to_slot_.end())
     {
         return true;
     }
 
     auto slot = request_slot();
 
+    if(handle_ == 0)
+    {
+        // sent once a real voice is taken
+        effect_to_slot_[effect] = slot;
+        return true;
+    }
+
     alSource3i(handle_,
                AL_AUXILIARY_SEND_FILTER,
                static_cast<ALint>(effect->get_aux_id()),
@@ -368,16 +1420,253 @@ void source_impl::unbind_source_aux_slot(builtin_effect_impl* effect)
     if (it != effect_to_slot_.end())
     {
         auto slot = it->second;
+        if(handle_ != 0)
+        {
+            al_check(alSource3i(handle_,
+                                AL_AUXILIARY_SEND_FILTER,
+                                AL_EFFECTSLOT_NULL,
+                                slot,
+                                0));
+        }
+        free_slots_.insert(slot);
+        effect_to_slot_.erase(it);
+    }
+}
+
+void source_impl::set_priority(int priority)
+{
+    priority_ = priority;
+}
+
+auto source_impl::get_priority() const -> int
+{
+    return priority_;
+}
+
+auto source_impl::get_audibility(const float3& listener_position) const -> float
+{
+    auto gain = muted_ ? 0.0f : get_gain() * direct_filter_.gain;
+
+    // the device uses the linear distance model
+    auto dx = position_[0] - listener_position[0];
+    auto dy = position_[1] - listener_position[1];
+    auto dz = position_[2] - listener_position[2];
+    auto distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    if(max_distance_ <= reference_distance_)
+    {
+        return gain;
+    }
+
+    distance = std::min(std::max(distance, reference_distance_), max_distance_);
+    auto attenuation = 1.0f - rolloff_ * (distance - reference_distance_) / (max_distance_ - reference_distance_);
+    return gain * std::min(std::max(attenuation, 0.0f), 1.0f);
+}
+
+auto source_impl::get_audible_distance() const -> float
+{
+    // linear attenuation is clamped at the max distance,
+    // it never reaches silence with a rolloff below 1
+    if(rolloff_ < 1.0f || max_distance_ <= reference_distance_ ||
+       max_distance_ >= std::numeric_limits<float>::max())
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+
+    return reference_distance_ + (max_distance_ - reference_distance_) / rolloff_;
+}
+
+auto source_impl::get_position() const -> const float3&
+{
+    return position_;
+}
+
+auto source_impl::is_virtual() const -> bool
+{
+    return handle_ == 0;
+}
+
+void source_impl::sync_virtual() const
+{
+    if(handle_ != 0)
+    {
+        return;
+    }
+
+    // the position is derived from the elapsed time only when asked for
+    auto clock = voice_pool::get_clock();
+    auto elapsed = clock - virtual_clock_;
+    virtual_clock_ = clock;
+
+    if(cached_state_ != AL_PLAYING)
+    {
+        return;
+    }
+
+    cached_offset_ += float(elapsed) * get_effective_pitch();
+
+    if(looping_ && bound_sound_ && bound_sound_->has_loop_points() && bound_sound_->are_loop_points_applied())
+    {
+        // the loop ends before the end of the sound, wrap within it
+        auto rate = float(bound_sound_->get_info().sample_rate);
+        auto loop_start = float(bound_sound_->get_loop_start()) / rate;
+        auto loop_end = float(bound_sound_->get_loop_end()) / rate;
+        if(loop_end > loop_start && cached_offset_ >= loop_end)
+        {
+            cached_offset_ = loop_start + std::fmod(cached_offset_ - loop_start, loop_end - loop_start);
+            return;
+        }
+    }
+
+    // the duration of a fed stream is not known
+    auto duration = get_playback_duration();
+    if(duration <= 0.0f || cached_offset_ < duration)
+    {
+        return;
+    }
+
+    if(looping_)
+    {
+        cached_offset_ = std::fmod(cached_offset_, duration);
+    }
+    else if(!next_sounds_.empty())
+    {
+        // the update moves on to the queued sound
+        return;
+    }
+    else
+    {
+        cached_state_ = AL_STOPPED;
+        cached_offset_ = 0.0f;
+        stream_playing_ = false;
+        finished();
+    }
+}
+
+void source_impl::promote(native_handle_type handle)
+{
+    sync_virtual();
+    auto state = cached_state_;
+    attach_voice(handle);
+
+    if(state == AL_PLAYING)
+    {
+        play();
+    }
+}
+
+void source_impl::demote()
+{
+    if(handle_ == 0)
+    {
+        return;
+    }
+
+    refresh_state();
+    auto state = cached_state_;
+    auto offset = get_playback_position();
+
+    // hand the voice back as good as new
+    al_check(alSourceRewind(handle_));
+    al_check(alSourcei(handle_, AL_BUFFER, 0));
+    clear_filters();
+
+    voice_pool::release(handle_);
+    handle_ = 0;
+
+    // all of the ring is unqueued now
+    free_stream_buffers_ = stream_buffers_;
+    queued_stream_chunks_.clear();
+    stream_primed_ = false;
+    stream_starved_ = false;
+    play_pending_ = false;
+    chained_after_ = 0;
+
+    cached_state_ = state;
+    cached_offset_ = offset;
+    virtual_clock_ = voice_pool::get_clock();
+}
+
+void source_impl::attach_voice(native_handle_type handle)
+{
+    auto offset = cached_offset_;
+    handle_ = handle;
+
+    // a pooled voice carries nothing over from its previous owner
+    al_check(alSourcei(handle_, AL_SOURCE_RELATIVE, AL_FALSE));
+    al_check(alSourcei(handle_, AL_LOOPING, (looping_ && !is_streaming()) ? AL_TRUE : AL_FALSE));
+    al_check(alSourcef(handle_, AL_GAIN, get_gain()));
+    al_check(alSourcef(handle_, AL_PITCH, get_effective_pitch()));
+    al_check(alSourcefv(handle_, AL_POSITION, position_.data()));
+    al_check(alSourcefv(handle_, AL_VELOCITY, velocity_.data()));
+    al_check(alSourcefv(handle_, AL_ORIENTATION, orientation_.data()));
+    al_check(alSourcef(handle_, AL_ROLLOFF_FACTOR, rolloff_));
+    al_check(alSourcef(handle_, AL_REFERENCE_DISTANCE, reference_distance_));
+    al_check(alSourcef(handle_, AL_MAX_DISTANCE, max_distance_));
+    // also when none, the previous owner may have left its filter on
+    apply_direct_filter();
+    dirty_ = 0;
+
+    for(const auto& send : effect_to_slot_)
+    {
         al_check(alSource3i(handle_,
                             AL_AUXILIARY_SEND_FILTER,
-                            AL_EFFECTSLOT_NULL,
-                            slot,
+                            static_cast<ALint>(send.first->get_aux_id()),
+                            send.second,
                             0));
-        free_slots_.insert(slot);
-        effect_to_slot_.erase(it);
+    }
+
+    if(!bound_sound_)
+    {
+        return;
+    }
+
+    // continue from where the virtual voice got to
+    if(is_streaming())
+    {
+        restart_stream(bound_sound_->get_byte_size_for(duration_t(offset)));
+        return;
+    }
+
+    const auto& handles = bound_sound_->native_handles();
+    if(!handles.empty())
+    {
+        enqueue_buffers(handles.data(), handles.size());
+        al_check(alSourcef(handle_, AL_SEC_OFFSET, offset));
+    }
+}
+
+void source_impl::clear_aux_sends() const
+{
+    for(const auto& send : effect_to_slot_)
+    {
+        al_check(alSource3i(handle_, AL_AUXILIARY_SEND_FILTER, AL_EFFECTSLOT_NULL, send.second, 0));
+    }
+}
+
+void source_impl::clear_filters() const
+{
+    clear_aux_sends();
+
+    // regardless of the current filter, a change to none
+    // may still be pending in an update batch
+    if(filter_pool::is_supported())
+    {
+        al_check(alSourcei(handle_, AL_DIRECT_FILTER, AL_FILTER_NULL));
     }
 }
 
+void source_impl::apply_direct_filter() const
+{
+    if(!filter_pool::is_supported())
+    {
+        return;
+    }
+
+    auto object = filter_pool::prepare(direct_filter_);
+    al_check(alSourcei(handle_, AL_DIRECT_FILTER, static_cast<ALint>(object)));
+}
+
 auto source_impl::request_slot() -> slot_type
 {
     if (free_slots_.empty())
@@ -390,5 +1679,136 @@ auto source_impl::request_slot() -> slot_type
     return slot;
 }
 
+void source_impl::set_on_stopped(stopped_callback callback)
+{
+    on_stopped_ = std::move(callback);
+}
+
+void source_impl::set_on_buffer_completed(buffer_completed_callback callback)
+{
+    on_buffer_completed_ = std::move(callback);
+}
+
+auto source_impl::get_on_stopped() const -> const stopped_callback&
+{
+    return on_stopped_;
+}
+
+auto source_impl::get_on_buffer_completed() const -> const buffer_completed_callback&
+{
+    return on_buffer_completed_;
+}
+
+void source_impl::on_buffers_completed(size_t count) const
+{
+    notify(count, false);
+}
+
+auto source_impl::take_notifications() const -> notifications
+{
+    auto result = notifications_;
+    notifications_ = {};
+    notified_ = false;
+    return result;
+}
+
+void source_impl::drop_stopped_notification() const
+{
+    // a stop noticed before playing again would be dispatched once the
+    // source plays already, e.g. a pooled one-shot would be recycled
+    notifications_.stopped = false;
+}
+
+void source_impl::invalidate_offset() const
+{
+    offset_stale_ = true;
+}
+
+void source_impl::finished() const
+{
+    // the mixer reports the completed buffers of the real voices itself,
+    // the buffers of a stream are counted as they are unqueued
+    bool reported = is_streaming() || (handle_ != 0 && source_events::is_enabled());
+    auto buffers = bound_sound_ ? bound_sound_->native_handles().size() : 0;
+    notify(reported ? 0 : buffers, true);
+}
+
+void source_impl::notify(size_t buffers_completed, bool stopped) const
+{
+    // nobody is listening
+    if(!on_stopped_ && !on_buffer_completed_)
+    {
+        return;
+    }
+
+    notifications_.buffers_completed += buffers_completed;
+    notifications_.stopped |= stopped;
+    if(!notified_)
+    {
+        notified_ = true;
+        source_events::post(this);
+    }
+}
+
+void source_impl::set_bus(bus_impl* bus, size_t slot)
+{
+    bus_ = bus;
+    bus_slot_ = slot;
+    paused_by_bus_ = false;
+}
+
+auto source_impl::get_bus() const -> bus_impl*
+{
+    return bus_;
+}
+
+auto source_impl::get_bus_slot() const -> size_t
+{
+    return bus_slot_;
+}
+
+void source_impl::set_bus_scale(float gain, float pitch) const
+{
+    if(gain != bus_gain_)
+    {
+        bus_gain_ = gain;
+        if(handle_ != 0 && !defer(dirty_gain))
+        {
+            al_check(alSourcef(handle_, AL_GAIN, get_gain()));
+        }
+    }
+
+    if(pitch != bus_pitch_)
+    {
+        // the virtual position advanced at the old pitch so far
+        sync_virtual();
+        bus_pitch_ = pitch;
+        if(handle_ != 0 && !defer(dirty_pitch))
+        {
+            al_check(alSourcef(handle_, AL_PITCH, get_effective_pitch()));
+        }
+    }
+}
+
+void source_impl::set_paused_by_bus(bool paused)
+{
+    paused_by_bus_ = paused;
+}
+
+auto source_impl::is_paused_by_bus() const -> bool
+{
+    return paused_by_bus_;
+}
+
+auto source_impl::get_gain() const -> float
+{
+    return volume_ * bus_gain_;
+}
+
+auto source_impl::get_effective_pitch() const -> float
+{
+    return pitch_ * bus_pitch_;
+}
+
 } // namespace detail
 } // namespace audio
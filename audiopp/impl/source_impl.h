@@ -1,26 +1,46 @@
 #pragma once
 
 #include "effects/builtin_effect_impl.h"
+#include "../filter.h"
+#include "../playback_position.h"
 #include "../types.h"
 #include "../sound_info.h"
+#include "stream_cursor.h"
 #include "al.h"
+#include <array>
 #include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <unordered_map>
 #include <set>
+#include <vector>
 
 namespace audio
 {
 
 class effect;
+class source;
 
 namespace detail
 {
 class sound_impl;
+class bus_impl;
 
 class source_impl
 {
 public:
     using native_handle_type = ALuint;
+    using stopped_callback = std::function<void(source&)>;
+    using buffer_completed_callback = std::function<void(source&, size_t)>;
+
+    /// what happened since the callbacks were last invoked
+    struct notifications
+    {
+        size_t buffers_completed{};
+        bool stopped{};
+    };
+
     source_impl();
     ~source_impl();
 
@@ -33,7 +53,14 @@ public:
     auto has_bound_sound() const -> bool;
     void unbind();
 
-    void set_loop(bool on) const;
+    /// plays the sound right after the bound one and those queued before it
+    auto queue_sound(sound_impl* sound) -> bool;
+    void clear_queued_sounds();
+    auto get_queued_sound_count() const -> size_t;
+    /// the queued sound is being destroyed
+    void forget_queued_sound(sound_impl* sound);
+
+    void set_loop(bool on);
     void set_volume(float volume) const;
     void set_pitch(float pitch) const;
     void set_position(const float3& position) const;
@@ -42,18 +69,28 @@ public:
 
     void set_volume_rolloff(float rolloff) const;
     void set_distance(float mind, float maxd) const;
+    void set_direct_filter(const filter& params) const;
+    auto get_direct_filter() const -> const filter&;
     void set_playback_position(float seconds);
     auto get_volume() const -> float;
     auto get_pitch() const -> float;
     auto get_playback_position() const -> float;
+    auto get_playback_position_precise() const -> playback_position;
     auto get_playback_duration() const -> float;
 
-    void play() const;
-    void stop() const;
-    void pause() const;
+    void play();
+    /// starts the real voices of all the sources in the same mix, the
+    /// virtual ones start once they get a voice
+    static void play_together(const std::vector<source_impl*>& sources, duration_t delay);
+    void stop();
+    void pause();
+    /// pauses the real voices of all the sources at once
+    static void pause_together(const std::vector<source_impl*>& sources);
     auto is_playing() const -> bool;
     auto is_paused() const -> bool;
     auto is_stopped() const -> bool;
+    void refresh_state() const;
+    void flush_properties() const;
     auto is_valid() const -> bool;
     auto is_looping() const -> bool;
 
@@ -62,21 +99,101 @@ public:
     auto is_muted() const -> bool;
 
     auto update_stream() -> bool;
+    auto is_streaming() const -> bool;
+    void set_stream_lead_time(duration_t lead_time);
+    auto get_stream_lead_time() const -> duration_t;
+    auto get_stream_offset() const -> size_t;
     auto native_handle() const -> native_handle_type;
     auto get_bound_sound_uid() const -> uintptr_t;
     auto get_bound_sound_info() const -> const sound_info&;
 
     void enqueue_buffers(const native_handle_type* handles, size_t count) const;
+    void on_buffer_uploaded(native_handle_type handle);
     void unqueue_buffers() const;
 
     auto get_queued_buffers() const -> size_t;
 
     auto bind_source_aux_slot_to_effect(builtin_effect_impl* effect) -> bool;
     void unbind_source_aux_slot(builtin_effect_impl* effect);
+
+    void set_priority(int priority);
+    auto get_priority() const -> int;
+    auto get_audibility(const float3& listener_position) const -> float;
+    auto get_audible_distance() const -> float;
+    auto get_position() const -> const float3&;
+    auto is_virtual() const -> bool;
+    void promote(native_handle_type handle);
+    void demote();
+
+    void set_on_stopped(stopped_callback callback);
+    void set_on_buffer_completed(buffer_completed_callback callback);
+    auto get_on_stopped() const -> const stopped_callback&;
+    auto get_on_buffer_completed() const -> const buffer_completed_callback&;
+    /// reported by the mixer
+    void on_buffers_completed(size_t count) const;
+    auto take_notifications() const -> notifications;
+    /// the playback position is queried again when asked for
+    void invalidate_offset() const;
+
+    /// the bus and the index into its sources
+    void set_bus(bus_impl* bus, size_t slot);
+    auto get_bus() const -> bus_impl*;
+    auto get_bus_slot() const -> size_t;
+    /// the volume and pitch of the bus and its parents multiplied
+    void set_bus_scale(float gain, float pitch) const;
+    void set_paused_by_bus(bool paused);
+    auto is_paused_by_bus() const -> bool;
 private:
     void bind_sound(sound_impl* sound);
     void unbind_sound();
 
+    /// the first queued sound becomes the bound one
+    void advance_queue();
+    /// queues the buffers of the next static sound after the bound ones
+    void chain_next_sound();
+    /// moves on to the next sound once the bound one was played
+    void update_queue();
+    /// plays the bound sound alone from where it is, before the queue changes
+    void unchain_sounds();
+    /// queues the buffers of the bound sound alone on the stopped voice
+    void requeue_bound_sound();
+    /// the sound the stream is read from, the bound or a queued one
+    auto get_stream_sound() const -> sound_impl*;
+    void reset_stream_sound();
+    void restart_stream(size_t offset);
+    auto refill_stream() -> bool;
+    auto get_queued_stream_size() const -> size_t;
+    /// returns whether the real voice has to be started
+    auto prepare_play() -> bool;
+    /// returns whether the real voice has to be paused
+    auto prepare_pause() -> bool;
+    /// what openal is given, scaled by the bus
+    auto get_gain() const -> float;
+    auto get_effective_pitch() const -> float;
+    auto query_state() const -> ALint;
+    auto defer(std::uint8_t property) const -> bool;
+    void sync_virtual() const;
+    void attach_voice(native_handle_type handle);
+    void clear_aux_sends() const;
+    /// takes the aux sends and the direct filter off the real voice
+    void clear_filters() const;
+    void apply_direct_filter() const;
+    /// played to the end on its own
+    void finished() const;
+    void notify(size_t buffers_completed, bool stopped) const;
+    /// the stop noticed so far is stale once played again
+    void drop_stopped_notification() const;
+
+    enum dirty_property : std::uint8_t
+    {
+        dirty_gain = 1 << 0,
+        dirty_pitch = 1 << 1,
+        dirty_position = 1 << 2,
+        dirty_velocity = 1 << 3,
+        dirty_orientation = 1 << 4,
+        dirty_filter = 1 << 5
+    };
+
     using slot_type = ALint;
 
     auto request_slot() -> slot_type;
@@ -87,10 +204,89 @@ private:
 
     /// non owning
     sound_impl* bound_sound_ = nullptr;
+    /// played in order after the bound sound, non owning
+    std::vector<sound_impl*> next_sounds_;
+    /// buffers of the bound static sound while the next one is chained after them
+    size_t chained_after_{};
+    /// reused for the buffers unqueued when moving on to the chained sound
+    std::vector<native_handle_type> unqueued_buffers_;
 
+    /// the real voice, 0 while the source is virtual
     native_handle_type handle_ = 0;
+    int priority_{};
+    /// shadow copies of the properties last set
+    mutable float volume_{1.0f};
+    mutable float pitch_{1.0f};
+    mutable float3 position_{};
+    mutable float3 velocity_{};
+    mutable std::array<float, 6> orientation_{{0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f}};
+    mutable float rolloff_{1.0f};
+    mutable float reference_distance_{1.0f};
+    mutable float max_distance_{std::numeric_limits<float>::max()};
+    mutable filter direct_filter_{};
+    /// properties set during an update batch, not flushed yet
+    mutable std::uint8_t dirty_{};
     mutable float muted_volume_{1.0f};
+    /// volatile state as of the last refresh, tracked
+    /// without openal while the source is virtual
+    mutable ALint cached_state_{AL_INITIAL};
+    mutable float cached_offset_{};
+    /// voice pool clock the virtual playback position was last advanced to
+    mutable double virtual_clock_{};
+    /// the cached offset is older than the last update
+    mutable bool offset_stale_{};
     mutable bool muted_{};
+    bool looping_{};
+
+    /// ring of buffers used to stream the bound sound. They are
+    /// unqueued once processed, refilled and queued back.
+    std::vector<native_handle_type> stream_buffers_;
+    /// buffers from the ring which are not queued at the moment
+    std::vector<native_handle_type> free_stream_buffers_;
+    struct stream_chunk
+    {
+        /// offset into the sound data
+        size_t offset{};
+        /// size of the chunk in bytes
+        size_t size{};
+        /// the bound or a queued sound, non owning
+        sound_impl* sound{};
+    };
+    /// chunks of the sound data held by the queued buffers, in queue order
+    std::vector<stream_chunk> queued_stream_chunks_;
+    /// position in the sound data to stream from next
+    std::unique_ptr<stream_cursor> stream_cursor_;
+    /// how many queued sounds the stream has moved on from the bound one
+    size_t stream_sound_index_{};
+    /// opened ahead for the sound the stream moves on to next
+    std::unique_ptr<stream_cursor> next_stream_cursor_;
+    /// how much audio should be queued ahead of the playback position
+    duration_t stream_lead_time_{1.0};
+    /// the lead time grown to compensate for underruns
+    duration_t stream_adapted_lead_time_{1.0};
+    /// the queue already starts from the desired playback position
+    bool stream_primed_{};
+    /// playback was requested and the stream is not finished yet
+    mutable bool stream_playing_{};
+    /// played everything fed so far and waits for more
+    bool stream_starved_{};
+    /// play was requested while the bound sound was still being uploaded
+    bool play_pending_{};
+
+    /// non owning
+    bus_impl* bus_{};
+    size_t bus_slot_{};
+    mutable float bus_gain_{1.0f};
+    mutable float bus_pitch_{1.0f};
+    /// paused along with the bus, resumed along with it too
+    bool paused_by_bus_{};
+
+    stopped_callback on_stopped_;
+    buffer_completed_callback on_buffer_completed_;
+    /// not yet handed to the callbacks
+    mutable notifications notifications_;
+    /// waits in the list of the sources to dispatch the callbacks of
+    mutable bool notified_{};
 };
 } // namespace detail
 } // namespace audio
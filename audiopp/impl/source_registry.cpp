@@ -0,0 +1,150 @@
+#include "source_registry.h"
+#include "../source.h"
+#include "source_impl.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace audio
+{
+namespace detail
+{
+namespace source_registry
+{
+
+namespace
+{
+/// parallel arrays indexed by the same slot
+struct state
+{
+    std::vector<source*> owners;
+    std::vector<source_impl*> impls;
+    std::vector<std::uint8_t> bound;
+    std::vector<std::uint8_t> has_effects;
+
+    std::unordered_map<const source_impl*, size_t> indices;
+};
+
+auto get_state() -> state&
+{
+    static state s;
+    return s;
+}
+
+template<typename T>
+void swap_remove(std::vector<T>& values, size_t index)
+{
+    values[index] = values.back();
+    values.pop_back();
+}
+} // namespace
+
+void add(source_impl* impl)
+{
+    auto& s = get_state();
+    s.indices[impl] = s.impls.size();
+    s.owners.push_back(nullptr);
+    s.impls.push_back(impl);
+    s.bound.push_back(0);
+    s.has_effects.push_back(0);
+}
+
+void remove(source_impl* impl)
+{
+    auto& s = get_state();
+    auto it = s.indices.find(impl);
+    if(it == std::end(s.indices))
+    {
+        return;
+    }
+
+    auto index = it->second;
+    s.indices.erase(it);
+
+    swap_remove(s.owners, index);
+    swap_remove(s.impls, index);
+    swap_remove(s.bound, index);
+    swap_remove(s.has_effects, index);
+
+    if(index != s.impls.size())
+    {
+        s.indices[s.impls[index]] = index;
+    }
+}
+
+void set_owner(source_impl* impl, source* owner)
+{
+    auto& s = get_state();
+    auto it = s.indices.find(impl);
+    if(it != std::end(s.indices))
+    {
+        s.owners[it->second] = owner;
+    }
+}
+
+auto get_owner(const source_impl* impl) -> source*
+{
+    auto& s = get_state();
+    auto it = s.indices.find(impl);
+    if(it == std::end(s.indices))
+    {
+        return nullptr;
+    }
+    return s.owners[it->second];
+}
+
+void set_bound(const source_impl* impl, bool bound)
+{
+    auto& s = get_state();
+    auto it = s.indices.find(impl);
+    if(it != std::end(s.indices))
+    {
+        s.bound[it->second] = bound ? 1 : 0;
+    }
+}
+
+void set_has_effects(const source_impl* impl, bool has_effects)
+{
+    auto& s = get_state();
+    auto it = s.indices.find(impl);
+    if(it != std::end(s.indices))
+    {
+        s.has_effects[it->second] = has_effects ? 1 : 0;
+    }
+}
+
+auto size() -> size_t
+{
+    return get_state().impls.size();
+}
+
+void update_streams()
+{
+    auto& s = get_state();
+    for(size_t i = 0; i < s.impls.size(); ++i)
+    {
+        if(s.bound[i] != 0)
+        {
+            s.impls[i]->update_stream();
+        }
+    }
+}
+
+void update_effects(duration_t dt)
+{
+    auto& s = get_state();
+
+    // indexed, since effects may create sources while being updated
+    for(size_t i = 0; i < s.owners.size(); ++i)
+    {
+        if(s.has_effects[i] != 0 && s.owners[i] != nullptr)
+        {
+            s.owners[i]->update_effects(dt);
+        }
+    }
+}
+
+} // namespace source_registry
+} // namespace detail
+} // namespace audio
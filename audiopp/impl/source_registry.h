@@ -0,0 +1,36 @@
+#pragma once
+
+#include "../types.h"
+
+namespace audio
+{
+class source;
+
+namespace detail
+{
+class source_impl;
+
+//-----------------------------------------------------------------------------
+/// All the live sources, kept packed for the central update.
+//-----------------------------------------------------------------------------
+namespace source_registry
+{
+void add(source_impl* impl);
+void remove(source_impl* impl);
+
+/// the public source owning the impl, it changes when the source is moved
+void set_owner(source_impl* impl, source* owner);
+auto get_owner(const source_impl* impl) -> source*;
+/// whether the source has a sound bound, the others have no stream to update
+void set_bound(const source_impl* impl, bool bound);
+/// whether the source has effects bound, the others have no effects to update
+void set_has_effects(const source_impl* impl, bool has_effects);
+
+auto size() -> size_t;
+
+void update_streams();
+void update_effects(duration_t dt);
+} // namespace source_registry
+
+} // namespace detail
+} // namespace audio
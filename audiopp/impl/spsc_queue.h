@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace audio
+{
+namespace detail
+{
+
+//-----------------------------------------------------------------------------
+/// Bounded lock-free queue for exactly one producer and one consumer thread.
+/// Neither side ever blocks, pushing into a full queue simply fails.
+//-----------------------------------------------------------------------------
+template <typename T>
+class spsc_queue
+{
+public:
+    explicit spsc_queue(size_t capacity)
+    {
+        // round up to a power of two so that indices can be masked
+        size_t size = 2;
+        while(size < capacity)
+        {
+            size <<= 1;
+        }
+        slots_.resize(size);
+        mask_ = size - 1;
+    }
+
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    //-----------------------------------------------------------------------------
+    /// Called by the producer only.
+    //-----------------------------------------------------------------------------
+    auto try_push(T&& value) -> bool
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if(tail - head_.load(std::memory_order_acquire) == slots_.size())
+        {
+            return false;
+        }
+
+        slots_[tail & mask_] = std::move(value);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------
+    /// Called by the consumer only.
+    //-----------------------------------------------------------------------------
+    auto try_pop(T& value) -> bool
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if(head == tail_.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        value = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    auto empty() const -> bool
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    auto capacity() const -> size_t
+    {
+        return slots_.size();
+    }
+
+private:
+    using index_type = std::atomic<size_t>;
+    static constexpr size_t cache_line_size = 64;
+
+    std::vector<T> slots_;
+    size_t mask_{};
+
+    /// keep the indices on separate cache lines so
+    /// the two threads don't keep invalidating each other
+    char pad0_[cache_line_size]{};
+    /// read position, written by the consumer
+    index_type head_{0};
+    char pad1_[cache_line_size - sizeof(index_type)]{};
+    /// write position, written by the producer
+    index_type tail_{0};
+    char pad2_[cache_line_size - sizeof(index_type)]{};
+};
+
+} // namespace detail
+} // namespace audio
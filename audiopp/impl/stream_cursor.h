@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace audio
+{
+namespace detail
+{
+
+//-----------------------------------------------------------------------------
+/// Read position of a source into a streamed sound. Every streaming source
+/// owns one, so that several sources can play the same sound independently.
+/// Positions are byte offsets into the decoded pcm data.
+//-----------------------------------------------------------------------------
+class stream_cursor
+{
+public:
+    virtual ~stream_cursor() = default;
+
+    //-----------------------------------------------------------------------------
+    /// Moves to the offset, clamped to the available data.
+    //-----------------------------------------------------------------------------
+    virtual void seek(size_t offset) = 0;
+
+    //-----------------------------------------------------------------------------
+    /// Gets the offset the next read starts from.
+    //-----------------------------------------------------------------------------
+    virtual auto tell() const -> size_t = 0;
+
+    //-----------------------------------------------------------------------------
+    /// Reads up to the desired size from the current offset and advances it.
+    /// The returned data stays valid until the next call. Returns the size
+    /// read, 0 at the end.
+    //-----------------------------------------------------------------------------
+    virtual auto read(size_t desired_size, const std::uint8_t*& data) -> size_t = 0;
+};
+
+} // namespace detail
+} // namespace audio
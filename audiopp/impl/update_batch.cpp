@@ -0,0 +1,117 @@
+#include "update_batch.h"
+#include "check.h"
+#include "extensions.h"
+#include "listener_impl.h"
+#include "source_impl.h"
+
+#include <algorithm>
+#include <alc.h>
+#include <vector>
+
+namespace audio
+{
+namespace detail
+{
+namespace update_batch
+{
+
+namespace
+{
+struct state
+{
+    /// nested begin calls
+    int depth{};
+    std::vector<const source_impl*> sources;
+    std::vector<listener_impl*> listeners;
+};
+
+auto get_state() -> state&
+{
+    static state s;
+    return s;
+}
+} // namespace
+
+void begin()
+{
+    auto& s = get_state();
+    if(s.depth++ > 0)
+    {
+        return;
+    }
+
+    const auto& ext = get_extensions();
+    if(ext.deferred_updates)
+    {
+        al_check(ext.alDeferUpdatesSOFT());
+    }
+    else
+    {
+        al_check(alcSuspendContext(alcGetCurrentContext()));
+    }
+}
+
+void end()
+{
+    auto& s = get_state();
+    if(s.depth == 0 || --s.depth > 0)
+    {
+        return;
+    }
+
+    auto sources = std::move(s.sources);
+    s.sources.clear();
+    for(auto source : sources)
+    {
+        source->flush_properties();
+    }
+
+    auto listeners = std::move(s.listeners);
+    s.listeners.clear();
+    for(auto listener : listeners)
+    {
+        listener->flush_properties();
+    }
+
+    // everything flushed is applied within the same mix
+    const auto& ext = get_extensions();
+    if(ext.deferred_updates)
+    {
+        al_check(ext.alProcessUpdatesSOFT());
+    }
+    else
+    {
+        al_check(alcProcessContext(alcGetCurrentContext()));
+    }
+}
+
+auto is_active() -> bool
+{
+    return get_state().depth > 0;
+}
+
+void mark_dirty(const source_impl* source)
+{
+    get_state().sources.emplace_back(source);
+}
+
+void mark_dirty(listener_impl* listener)
+{
+    get_state().listeners.emplace_back(listener);
+}
+
+void forget(const source_impl* source)
+{
+    auto& sources = get_state().sources;
+    sources.erase(std::remove(std::begin(sources), std::end(sources), source), std::end(sources));
+}
+
+void forget(listener_impl* listener)
+{
+    auto& listeners = get_state().listeners;
+    listeners.erase(std::remove(std::begin(listeners), std::end(listeners), listener), std::end(listeners));
+}
+
+} // namespace update_batch
+} // namespace detail
+} // namespace audio
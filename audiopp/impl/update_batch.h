@@ -0,0 +1,28 @@
+#pragma once
+
+namespace audio
+{
+namespace detail
+{
+class source_impl;
+class listener_impl;
+
+//-----------------------------------------------------------------------------
+/// Holds back property changes made between begin and end and commits them
+/// to OpenAL at once. Properties set several times are flushed only once.
+//-----------------------------------------------------------------------------
+namespace update_batch
+{
+void begin();
+void end();
+auto is_active() -> bool;
+
+/// the object gets its dirty properties flushed at the end
+void mark_dirty(const source_impl* source);
+void mark_dirty(listener_impl* listener);
+void forget(const source_impl* source);
+void forget(listener_impl* listener);
+} // namespace update_batch
+
+} // namespace detail
+} // namespace audio
@@ -0,0 +1,146 @@
+#include "upload_thread.h"
+#include "../logger.h"
+#include "check.h"
+#include "extensions.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace audio
+{
+namespace detail
+{
+
+namespace
+{
+struct upload_state
+{
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::deque<std::shared_ptr<upload_ticket>> tickets;
+    bool running{};
+};
+
+auto get_state() -> upload_state&
+{
+    static upload_state s;
+    return s;
+}
+
+void upload(upload_ticket& ticket)
+{
+    ALuint buffer{0};
+    al_check(alGenBuffers(1, &buffer));
+
+    const auto& ext = get_extensions();
+    if(ticket.use_static)
+    {
+        al_check(ext.alBufferDataStatic(buffer, ticket.format, ticket.data.data(), ALsizei(ticket.data.size()),
+                                        ticket.sample_rate));
+    }
+    else
+    {
+        al_check(alBufferData(buffer, ticket.format, ticket.data.data(), ALsizei(ticket.data.size()),
+                              ticket.sample_rate));
+        // openal has its own copy now
+        ticket.data = {};
+    }
+
+    ticket.buffer = buffer;
+
+    auto expected = upload_ticket::state::pending;
+    if(!ticket.status.compare_exchange_strong(expected, upload_ticket::state::done))
+    {
+        // nobody is waiting for it anymore
+        al_check(alDeleteBuffers(1, &buffer));
+    }
+}
+
+void run(ALCcontext* context)
+{
+    set_upload_thread(true);
+    get_extensions().alcSetThreadContext(context);
+
+    auto& s = get_state();
+    while(true)
+    {
+        std::shared_ptr<upload_ticket> ticket;
+        {
+            std::unique_lock<std::mutex> lock(s.mutex);
+            s.wakeup.wait(lock, [&]() { return !s.running || !s.tickets.empty(); });
+            if(!s.running)
+            {
+                break;
+            }
+
+            ticket = std::move(s.tickets.front());
+            s.tickets.pop_front();
+        }
+
+        if(ticket->status == upload_ticket::state::pending)
+        {
+            upload(*ticket);
+        }
+    }
+
+    get_extensions().alcSetThreadContext(nullptr);
+    set_upload_thread(false);
+}
+} // namespace
+
+void start_upload_thread(ALCcontext* context)
+{
+    if(!get_extensions().thread_local_context)
+    {
+        return;
+    }
+
+    auto& s = get_state();
+    s.running = true;
+    s.thread = std::thread(run, context);
+}
+
+void stop_upload_thread()
+{
+    auto& s = get_state();
+    if(!s.thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.running = false;
+        // uploads not started yet stay pending forever
+        s.tickets.clear();
+    }
+    s.wakeup.notify_one();
+    s.thread.join();
+}
+
+auto has_upload_thread() -> bool
+{
+    return get_state().thread.joinable();
+}
+
+void post_upload(const std::shared_ptr<upload_ticket>& ticket)
+{
+    auto& s = get_state();
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        s.tickets.emplace_back(ticket);
+    }
+    s.wakeup.notify_one();
+}
+
+auto abandon_upload(upload_ticket& ticket) -> bool
+{
+    auto expected = upload_ticket::state::pending;
+    return ticket.status.compare_exchange_strong(expected, upload_ticket::state::abandoned);
+}
+
+} // namespace detail
+} // namespace audio
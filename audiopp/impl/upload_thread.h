@@ -0,0 +1,59 @@
+#pragma once
+
+#include <al.h>
+#include <alc.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace audio
+{
+namespace detail
+{
+
+//-----------------------------------------------------------------------------
+/// A buffer upload handed over to the upload thread. Whoever loses the race
+/// between completing and abandoning it has to delete the buffer.
+//-----------------------------------------------------------------------------
+struct upload_ticket
+{
+    enum class state
+    {
+        pending,
+        done,
+        abandoned
+    };
+
+    std::vector<std::uint8_t> data;
+    ALenum format{};
+    ALsizei sample_rate{};
+    /// let openal read from the data directly
+    bool use_static{};
+
+    /// valid once done
+    ALuint buffer{};
+    std::atomic<state> status{state::pending};
+};
+
+//-----------------------------------------------------------------------------
+/// Starts a thread which has the context made current for itself only.
+/// Does nothing unless ALC_EXT_thread_local_context is supported.
+//-----------------------------------------------------------------------------
+void start_upload_thread(ALCcontext* context);
+void stop_upload_thread();
+auto has_upload_thread() -> bool;
+
+//-----------------------------------------------------------------------------
+/// Queues the upload. Poll the status of the ticket for completion.
+//-----------------------------------------------------------------------------
+void post_upload(const std::shared_ptr<upload_ticket>& ticket);
+
+//-----------------------------------------------------------------------------
+/// Gives up a pending upload. Returns false if it's done already and the
+/// buffer has to be taken care of by the caller.
+//-----------------------------------------------------------------------------
+auto abandon_upload(upload_ticket& ticket) -> bool;
+
+} // namespace detail
+} // namespace audio
@@ -0,0 +1,631 @@
+#include "voice_pool.h"
+#include "../logger.h"
+#include "check.h"
+#include "listener_impl.h"
+#include "source_events.h"
+#include "source_impl.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace audio
+{
+namespace detail
+{
+namespace voice_pool
+{
+
+namespace
+{
+/// gain under which a voice is not worth mixing, about -80dB
+constexpr float inaudible_gain = 0.0001f;
+constexpr size_t npos = size_t(-1);
+
+struct cell
+{
+    std::array<std::int64_t, 3> coord{};
+    /// indices into the voices
+    std::vector<size_t> voices;
+};
+
+struct voice
+{
+    source_impl* source{};
+    /// got a real voice in the current update
+    bool wanted{};
+    /// the grid cell of the position or the unbounded one
+    cell* home{};
+    /// index into the voices of the home
+    size_t slot{};
+    /// how far from the listener it can still be heard
+    float radius{};
+    std::multiset<float>::iterator radius_it;
+    /// index into the real voices, npos while virtual
+    size_t real_slot{npos};
+};
+
+struct candidate
+{
+    /// index into the voices
+    size_t index{};
+    int priority{};
+    float audibility{};
+};
+
+struct state
+{
+    /// all the logical voices
+    std::vector<voice> voices;
+    std::unordered_map<const source_impl*, size_t> indices;
+    /// indices of the voices which own a real voice
+    std::vector<size_t> real;
+    /// time advanced by the updates, virtual voices derive their position from it
+    double clock{};
+
+    /// uniform grid over the positions of the voices which
+    /// can be heard within a finite distance only
+    float cell_size{32.0f};
+    std::unordered_map<std::uint64_t, cell> cells;
+    /// voices which can be heard from anywhere
+    cell unbounded;
+    /// the audible distances of the voices in the grid
+    std::multiset<float> radii;
+
+    /// generated openal sources not used by any voice
+    std::vector<ALuint> free;
+    size_t generated{};
+
+    /// requested limit, 0 means the device one
+    size_t max_voices{};
+    /// how many sources the device can mix, 0 when unknown
+    size_t device_voices{};
+
+    voice_stats stats;
+
+    /// scratch storage reused by every update
+    std::vector<candidate> candidates;
+    std::vector<size_t> idle;
+};
+
+auto cell_coord(float position, float cell_size) -> std::int64_t
+{
+    // keeps the packed key unique
+    constexpr double limit = double(1 << 20) - 1.0;
+    auto coord = std::floor(double(position) / double(cell_size));
+    return std::int64_t(std::min(std::max(coord, -limit), limit));
+}
+
+auto cell_key(const std::array<std::int64_t, 3>& coord) -> std::uint64_t
+{
+    constexpr std::uint64_t mask = (1u << 21) - 1;
+    return ((std::uint64_t(coord[0]) & mask) << 42) | ((std::uint64_t(coord[1]) & mask) << 21) |
+           (std::uint64_t(coord[2]) & mask);
+}
+
+void unlink(state& s, size_t index)
+{
+    auto& v = s.voices[index];
+    if(!v.home)
+    {
+        return;
+    }
+
+    auto& voices = v.home->voices;
+    voices[v.slot] = voices.back();
+    s.voices[voices[v.slot]].slot = v.slot;
+    voices.pop_back();
+
+    if(v.home != &s.unbounded)
+    {
+        s.radii.erase(v.radius_it);
+        if(voices.empty())
+        {
+            s.cells.erase(cell_key(v.home->coord));
+        }
+    }
+    v.home = nullptr;
+}
+
+void link(state& s, size_t index)
+{
+    auto& v = s.voices[index];
+    v.radius = v.source->get_audible_distance();
+
+    if(std::isinf(v.radius))
+    {
+        v.home = &s.unbounded;
+    }
+    else
+    {
+        const auto& position = v.source->get_position();
+        std::array<std::int64_t, 3> coord{{cell_coord(position[0], s.cell_size),
+                                           cell_coord(position[1], s.cell_size),
+                                           cell_coord(position[2], s.cell_size)}};
+        v.home = &s.cells[cell_key(coord)];
+        v.home->coord = coord;
+        v.radius_it = s.radii.insert(v.radius);
+    }
+
+    v.slot = v.home->voices.size();
+    v.home->voices.push_back(index);
+}
+
+template<typename F>
+void visit_cell(const cell& c, F&& func)
+{
+    for(auto index : c.voices)
+    {
+        func(index);
+    }
+}
+
+/// visits the voices which may be audible from the position
+template<typename F>
+void query(const state& s, const float3& position, F&& func)
+{
+    visit_cell(s.unbounded, func);
+
+    if(s.radii.empty())
+    {
+        return;
+    }
+
+    // the farthest reaching voice decides how many cells around to look at
+    auto radius = *s.radii.rbegin();
+    std::array<std::int64_t, 3> min{};
+    std::array<std::int64_t, 3> max{};
+    double volume = 1.0;
+    for(size_t i = 0; i < 3; ++i)
+    {
+        min[i] = cell_coord(position[i] - radius, s.cell_size);
+        max[i] = cell_coord(position[i] + radius, s.cell_size);
+        volume *= double(max[i] - min[i] + 1);
+    }
+
+    // walk whichever is smaller, the cell range or the occupied cells
+    if(volume > double(s.cells.size()))
+    {
+        for(const auto& c : s.cells)
+        {
+            const auto& coord = c.second.coord;
+            if(coord[0] >= min[0] && coord[0] <= max[0] && coord[1] >= min[1] && coord[1] <= max[1] &&
+               coord[2] >= min[2] && coord[2] <= max[2])
+            {
+                visit_cell(c.second, func);
+            }
+        }
+        return;
+    }
+
+    std::array<std::int64_t, 3> coord{};
+    for(coord[0] = min[0]; coord[0] <= max[0]; ++coord[0])
+    {
+        for(coord[1] = min[1]; coord[1] <= max[1]; ++coord[1])
+        {
+            for(coord[2] = min[2]; coord[2] <= max[2]; ++coord[2])
+            {
+                auto it = s.cells.find(cell_key(coord));
+                if(it != std::end(s.cells))
+                {
+                    visit_cell(it->second, func);
+                }
+            }
+        }
+    }
+}
+
+auto get_state() -> state&
+{
+    static state s;
+    return s;
+}
+
+auto get_max_voices(const state& s) -> size_t
+{
+    auto max_voices = s.max_voices != 0 ? s.max_voices : std::numeric_limits<size_t>::max();
+    if(s.device_voices != 0)
+    {
+        max_voices = std::min(max_voices, s.device_voices);
+    }
+    return max_voices;
+}
+
+void make_real(state& s, size_t index)
+{
+    s.voices[index].real_slot = s.real.size();
+    s.real.push_back(index);
+}
+
+void make_virtual(state& s, size_t index)
+{
+    auto& v = s.voices[index];
+    if(v.real_slot == npos)
+    {
+        return;
+    }
+
+    s.real[v.real_slot] = s.real.back();
+    s.voices[s.real[v.real_slot]].real_slot = v.real_slot;
+    s.real.pop_back();
+    v.real_slot = npos;
+}
+
+void demote(state& s, size_t index)
+{
+    // the events posted so far belong to the source losing the voice
+    source_events::poll();
+    make_virtual(s, index);
+    s.voices[index].source->demote();
+    s.stats.demotions++;
+}
+
+auto try_promote(state& s, size_t index) -> bool
+{
+    auto handle = acquire();
+    if(handle == 0)
+    {
+        return false;
+    }
+
+    make_real(s, index);
+    s.voices[index].source->promote(handle);
+    return true;
+}
+} // namespace
+
+void init(ALCdevice* device)
+{
+    ALCint mono = 0;
+    ALCint stereo = 0;
+    alcGetIntegerv(device, ALC_MONO_SOURCES, 1, &mono);
+    alcGetIntegerv(device, ALC_STEREO_SOURCES, 1, &stereo);
+
+    auto& s = get_state();
+    s.device_voices = size_t(std::max(mono, 0) + std::max(stereo, 0));
+
+    info() << "-- Real voices : " << s.device_voices;
+}
+
+void shutdown()
+{
+    auto& s = get_state();
+    if(!s.free.empty())
+    {
+        al_check(alDeleteSources(ALsizei(s.free.size()), s.free.data()));
+    }
+    s.generated -= s.free.size();
+    s.free.clear();
+    s.device_voices = 0;
+}
+
+void set_max_voices(size_t count)
+{
+    get_state().max_voices = count;
+}
+
+auto get_max_voices() -> size_t
+{
+    return get_max_voices(get_state());
+}
+
+auto get_stats() -> voice_stats
+{
+    auto& s = get_state();
+    auto stats = s.stats;
+    stats.max_voices = get_max_voices(s);
+    stats.logical = s.voices.size();
+    stats.real = s.real.size();
+    stats.virtualized = stats.logical - stats.real;
+    return stats;
+}
+
+void set_cell_size(float size)
+{
+    auto& s = get_state();
+    if(size <= 0.0f || size == s.cell_size)
+    {
+        return;
+    }
+
+    s.cell_size = size;
+    for(size_t i = 0; i < s.voices.size(); ++i)
+    {
+        unlink(s, i);
+        link(s, i);
+    }
+}
+
+auto get_cell_size() -> float
+{
+    return get_state().cell_size;
+}
+
+void add(source_impl* source)
+{
+    auto& s = get_state();
+    auto index = s.voices.size();
+    s.indices[source] = index;
+    s.voices.emplace_back();
+    s.voices.back().source = source;
+    link(s, index);
+
+    try_promote(s, index);
+}
+
+void relocate(const source_impl* source)
+{
+    auto& s = get_state();
+    auto it = s.indices.find(source);
+    if(it == std::end(s.indices))
+    {
+        return;
+    }
+
+    auto index = it->second;
+    auto& v = s.voices[index];
+    auto radius = v.source->get_audible_distance();
+    if(v.home == &s.unbounded && std::isinf(radius))
+    {
+        return;
+    }
+
+    if(v.home && v.home != &s.unbounded && radius == v.radius)
+    {
+        const auto& position = v.source->get_position();
+        const auto& coord = v.home->coord;
+        if(cell_coord(position[0], s.cell_size) == coord[0] &&
+           cell_coord(position[1], s.cell_size) == coord[1] &&
+           cell_coord(position[2], s.cell_size) == coord[2])
+        {
+            // moved within its cell
+            return;
+        }
+    }
+
+    unlink(s, index);
+    link(s, index);
+}
+
+void remove(source_impl* source)
+{
+    auto& s = get_state();
+    auto it = s.indices.find(source);
+    if(it == std::end(s.indices))
+    {
+        return;
+    }
+
+    // swap with the last one to keep the voices packed
+    auto index = it->second;
+    if(s.voices[index].real_slot != npos)
+    {
+        // or they would go to the next source taking the voice
+        source_events::poll();
+    }
+    s.indices.erase(it);
+    unlink(s, index);
+    make_virtual(s, index);
+
+    auto last = s.voices.size() - 1;
+    if(index != last)
+    {
+        auto& v = s.voices[index];
+        v = s.voices[last];
+        s.indices[v.source] = index;
+        if(v.home)
+        {
+            v.home->voices[v.slot] = index;
+        }
+        if(v.real_slot != npos)
+        {
+            s.real[v.real_slot] = index;
+        }
+    }
+    s.voices.pop_back();
+}
+
+auto acquire() -> ALuint
+{
+    auto& s = get_state();
+    if(!s.free.empty())
+    {
+        auto handle = s.free.back();
+        s.free.pop_back();
+        return handle;
+    }
+
+    if(s.generated >= get_max_voices(s))
+    {
+        return 0;
+    }
+
+    ALuint handle = 0;
+    al_check(alGenSources(1, &handle));
+    if(handle == 0)
+    {
+        // the device told us less than it can actually mix
+        s.device_voices = s.generated;
+        info() << "Real voices limited to " << s.generated;
+        return 0;
+    }
+
+    s.generated++;
+    return handle;
+}
+
+void release(ALuint handle)
+{
+    auto& s = get_state();
+    if(s.generated > get_max_voices(s))
+    {
+        // the limit was lowered meanwhile
+        al_check(alDeleteSources(1, &handle));
+        s.generated--;
+        return;
+    }
+
+    s.free.push_back(handle);
+}
+
+auto find(ALuint handle) -> source_impl*
+{
+    auto& s = get_state();
+    for(auto index : s.real)
+    {
+        auto source = s.voices[index].source;
+        if(source->native_handle() == handle)
+        {
+            return source;
+        }
+    }
+    return nullptr;
+}
+
+void refresh_states()
+{
+    auto& s = get_state();
+    for(auto index : s.real)
+    {
+        s.voices[index].source->refresh_state();
+    }
+}
+
+void update(duration_t dt)
+{
+    auto& s = get_state();
+    const auto& listener = listener_impl::get_current_position();
+    s.clock += dt.count();
+
+    // virtual voices are not touched, they catch up when asked for their state.
+    // With source events the real ones are told when they stop, so only the
+    // playback position has to be queried again, once somebody asks for it.
+    bool events = source_events::is_enabled();
+    for(auto index : s.real)
+    {
+        auto& v = s.voices[index];
+        v.wanted = false;
+        if(events)
+        {
+            v.source->invalidate_offset();
+        }
+        else
+        {
+            v.source->refresh_state();
+        }
+    }
+
+    // only the voices near enough to the listener are worth testing
+    auto& candidates = s.candidates;
+    candidates.clear();
+    size_t tested = 0;
+    query(s, listener, [&](size_t i) {
+        auto& v = s.voices[i];
+        v.wanted = false;
+        if(!v.source->is_playing())
+        {
+            return;
+        }
+
+        tested++;
+        auto audibility = v.source->get_audibility(listener);
+        if(audibility > inaudible_gain)
+        {
+            candidates.push_back({i, v.source->get_priority(), audibility});
+        }
+    });
+    s.stats.tested = tested;
+
+    // only the ones which make it into the pool need to be ordered
+    auto wanted = std::min(candidates.size(), get_max_voices(s));
+    auto wanted_end = std::begin(candidates) + std::ptrdiff_t(wanted);
+    std::nth_element(std::begin(candidates), wanted_end, std::end(candidates),
+                     [](const candidate& lhs, const candidate& rhs) {
+                         if(lhs.priority != rhs.priority)
+                         {
+                             return lhs.priority > rhs.priority;
+                         }
+                         return lhs.audibility > rhs.audibility;
+                     });
+
+    for(auto it = std::begin(candidates); it != wanted_end; ++it)
+    {
+        s.voices[it->index].wanted = true;
+    }
+
+    // take the real voices away from the playing ones which did not make it.
+    // Idle ones keep theirs until somebody needs it.
+    auto& idle = s.idle;
+    idle.clear();
+    for(size_t i = 0; i < s.real.size();)
+    {
+        auto index = s.real[i];
+        const auto& v = s.voices[index];
+        if(v.wanted)
+        {
+            ++i;
+            continue;
+        }
+
+        if(v.source->is_playing() || s.generated > get_max_voices(s))
+        {
+            // the last real voice takes its place
+            demote(s, index);
+            continue;
+        }
+
+        idle.push_back(index);
+        ++i;
+    }
+
+    for(auto it = std::begin(candidates); it != wanted_end; ++it)
+    {
+        if(s.voices[it->index].real_slot != npos)
+        {
+            continue;
+        }
+
+        if(!try_promote(s, it->index))
+        {
+            if(idle.empty())
+            {
+                continue;
+            }
+
+            demote(s, idle.back());
+            idle.pop_back();
+
+            if(!try_promote(s, it->index))
+            {
+                continue;
+            }
+        }
+        s.stats.promotions++;
+    }
+}
+
+auto get_clock() -> double
+{
+    return get_state().clock;
+}
+
+auto try_promote(source_impl* source) -> bool
+{
+    auto& s = get_state();
+    auto it = s.indices.find(source);
+    if(it == std::end(s.indices) || !try_promote(s, it->second))
+    {
+        return false;
+    }
+
+    s.stats.promotions++;
+    return true;
+}
+
+} // namespace voice_pool
+} // namespace detail
+} // namespace audio
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "../voices.h"
+
+#include <al.h>
+#include <alc.h>
+
+namespace audio
+{
+namespace detail
+{
+class source_impl;
+
+//-----------------------------------------------------------------------------
+/// Bounded pool of real OpenAL sources shared by all the sources, which are
+/// only logical voices.
+//-----------------------------------------------------------------------------
+namespace voice_pool
+{
+/// reads how many sources the device can mix
+void init(ALCdevice* device);
+/// deletes the pooled openal sources
+void shutdown();
+
+void set_max_voices(size_t count);
+auto get_max_voices() -> size_t;
+auto get_stats() -> voice_stats;
+
+/// sets the size of the cells of the grid the voices are looked up with
+void set_cell_size(float size);
+auto get_cell_size() -> float;
+
+void add(source_impl* source);
+void remove(source_impl* source);
+/// moves the voice in the grid after its position or audible distance changed
+void relocate(const source_impl* source);
+
+/// gets a free real voice or 0 if all are taken
+auto acquire() -> ALuint;
+/// takes back a stopped real voice with no buffers queued
+void release(ALuint handle);
+/// hands a free real voice to the virtual source if there is one
+auto try_promote(source_impl* source) -> bool;
+
+/// the source holding the real voice or nullptr
+auto find(ALuint handle) -> source_impl*;
+/// queries the state of all the real voices
+void refresh_states();
+
+/// advances the clock and reassigns the real voices
+void update(duration_t dt);
+/// time advanced by the updates so far
+auto get_clock() -> double;
+} // namespace voice_pool
+
+} // namespace detail
+} // namespace audio
@@ -1,10 +1,19 @@
 #pragma once
 
+#include "bus.h"
 #include "device.h"
 #include "exception.h"
+#include "filter.h"
 #include "listener.h"
 #include "logger.h"
+#include "loopback_device.h"
+#include "oneshot.h"
+#include "playback_position.h"
+#include "playlist.h"
 #include "sound.h"
+#include "sound_budget.h"
 #include "source.h"
+#include "system.h"
+#include "voices.h"
 #include "effects/effect.h"
 #include "effects/builtin_effect.h"
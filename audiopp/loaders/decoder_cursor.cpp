@@ -0,0 +1,468 @@
+#include "decoder_cursor.h"
+#include "decoders/decoder_flac.h"
+#include "decoders/decoder_mp3.h"
+#include "decoders/decoder_vorbis.h"
+#include "decoders/decoder_wav.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace audio
+{
+namespace detail
+{
+
+namespace
+{
+
+void fill_info(sound_info& info, std::uint32_t channels, std::uint32_t sample_rate, std::uint64_t frames)
+{
+    info.channels = std::uint8_t(channels);
+    info.sample_rate = sample_rate;
+    info.bits_per_sample = 16;
+    info.frames = frames;
+    info.duration = duration_t(duration_t::rep(info.frames) / duration_t::rep(info.sample_rate));
+}
+
+auto has_frames(const sound_info& info, std::string& err) -> bool
+{
+    if(info.frames == 0)
+    {
+        err = "No frames loaded.";
+        return false;
+    }
+    return true;
+}
+
+/// position of a frame in the mp3 stream
+struct mp3_frame
+{
+    /// byte offset of the frame in the encoded data
+    std::size_t pos{};
+    /// index of its first pcm frame
+    std::uint64_t first{};
+};
+
+/// the most a layer 3 frame can refer back into the previous ones
+constexpr std::size_t max_reservoir_bytes = 512;
+
+auto get_frame_samples(const mp3dec_frame_info_t& fi) -> int
+{
+    if(fi.layer == 1)
+    {
+        return 384;
+    }
+    // mpeg 2 and 2.5 layer 3 frames are half as long
+    if(fi.layer == 3 && fi.hz < 32000)
+    {
+        return 576;
+    }
+    return 1152;
+}
+
+/// walks the frame headers without decoding any audio
+auto index_mp3(const std::uint8_t* data, std::size_t data_size, std::vector<mp3_frame>* frames,
+               mp3dec_frame_info_t& frame_info) -> std::uint64_t
+{
+    mp3dec_t dec{};
+    mp3dec_init(&dec);
+
+    std::uint64_t total = 0;
+    std::size_t pos = 0;
+    while(pos < data_size)
+    {
+        mp3dec_frame_info_t fi{};
+        auto samples = mp3dec_decode_frame(&dec, data + pos, int(data_size - pos), nullptr, &fi);
+        if(fi.frame_bytes == 0)
+        {
+            break;
+        }
+
+        if(samples > 0)
+        {
+            if(total == 0)
+            {
+                frame_info = fi;
+            }
+            if(frames)
+            {
+                // the frame starts after whatever was skipped to sync
+                frames->push_back({pos, total});
+            }
+            total += std::uint64_t(samples);
+        }
+        pos += std::size_t(fi.frame_bytes);
+    }
+
+    return total;
+}
+
+//-----------------------------------------------------------------------------
+/// Decodes into a small buffer of its own on every read.
+//-----------------------------------------------------------------------------
+class decoder_cursor : public stream_cursor
+{
+public:
+    decoder_cursor(const sound_info& info)
+        : channels_(info.channels)
+        , frames_(info.frames)
+    {
+    }
+
+    void seek(size_t offset) override
+    {
+        auto frame = std::min(std::uint64_t(offset / get_frame_size()), frames_);
+        if(!seek_to_frame(frame))
+        {
+            // stay at the end rather than reading from a wrong position
+            frame = frames_;
+        }
+        frame_ = frame;
+    }
+
+    auto tell() const -> size_t override
+    {
+        return size_t(frame_) * get_frame_size();
+    }
+
+    auto read(size_t desired_size, const std::uint8_t*& data) -> size_t override
+    {
+        auto frames = std::min(std::uint64_t(desired_size / get_frame_size()), frames_ - frame_);
+        if(frames == 0)
+        {
+            return 0;
+        }
+
+        buffer_.resize(size_t(frames) * channels_);
+        auto read = decode(buffer_.data(), frames);
+        frame_ += read;
+
+        data = reinterpret_cast<const std::uint8_t*>(buffer_.data());
+        return size_t(read) * get_frame_size();
+    }
+
+protected:
+    virtual auto seek_to_frame(std::uint64_t frame) -> bool = 0;
+    virtual auto decode(std::int16_t* out, std::uint64_t frames) -> std::uint64_t = 0;
+
+    auto get_frame_size() const -> size_t
+    {
+        return channels_ * sizeof(std::int16_t);
+    }
+
+    size_t channels_{};
+    std::uint64_t frames_{};
+
+private:
+    std::uint64_t frame_{};
+    std::vector<std::int16_t> buffer_;
+};
+
+class wav_cursor : public decoder_cursor
+{
+public:
+    wav_cursor(const std::uint8_t* data, std::size_t data_size, const sound_info& info)
+        : decoder_cursor(info)
+        , data_(data)
+        , data_size_(data_size)
+        , decoder_(drwav_open_memory(data, data_size))
+    {
+    }
+
+    ~wav_cursor() override
+    {
+        drwav_close(decoder_);
+    }
+
+protected:
+    auto seek_to_frame(std::uint64_t frame) -> bool override
+    {
+        if(decoder_ && is_adpcm() && frame * channels_ < decoder_->compressed.iCurrentSample)
+        {
+            // dr_wav keeps the block decoded last when seeking back to the start
+            // of adpcm data, which then gets mixed into the frames read after it
+            drwav_close(decoder_);
+            decoder_ = drwav_open_memory(data_, data_size_);
+        }
+        return decoder_ && drwav_seek_to_pcm_frame(decoder_, frame);
+    }
+
+    auto decode(std::int16_t* out, std::uint64_t frames) -> std::uint64_t override
+    {
+        return decoder_ ? drwav_read_pcm_frames_s16(decoder_, frames, out) : 0;
+    }
+
+private:
+    auto is_adpcm() const -> bool
+    {
+        return decoder_->translatedFormatTag == DR_WAVE_FORMAT_ADPCM ||
+               decoder_->translatedFormatTag == DR_WAVE_FORMAT_DVI_ADPCM;
+    }
+
+    const std::uint8_t* data_{};
+    std::size_t data_size_{};
+    drwav* decoder_{};
+};
+
+class flac_cursor : public decoder_cursor
+{
+public:
+    flac_cursor(const std::uint8_t* data, std::size_t data_size, const sound_info& info)
+        : decoder_cursor(info)
+        , decoder_(drflac_open_memory(data, data_size))
+    {
+    }
+
+    ~flac_cursor() override
+    {
+        drflac_close(decoder_);
+    }
+
+protected:
+    auto seek_to_frame(std::uint64_t frame) -> bool override
+    {
+        return decoder_ && drflac_seek_to_pcm_frame(decoder_, frame);
+    }
+
+    auto decode(std::int16_t* out, std::uint64_t frames) -> std::uint64_t override
+    {
+        return decoder_ ? drflac_read_pcm_frames_s16(decoder_, frames, out) : 0;
+    }
+
+private:
+    drflac* decoder_{};
+};
+
+class ogg_cursor : public decoder_cursor
+{
+public:
+    ogg_cursor(const std::uint8_t* data, std::size_t data_size, const sound_info& info)
+        : decoder_cursor(info)
+    {
+        int vorb_err = 0;
+        decoder_ = stb_vorbis_open_memory(data, int(data_size), &vorb_err, nullptr);
+    }
+
+    ~ogg_cursor() override
+    {
+        if(decoder_)
+        {
+            stb_vorbis_close(decoder_);
+        }
+    }
+
+protected:
+    auto seek_to_frame(std::uint64_t frame) -> bool override
+    {
+        return decoder_ && stb_vorbis_seek(decoder_, unsigned(frame)) != 0;
+    }
+
+    auto decode(std::int16_t* out, std::uint64_t frames) -> std::uint64_t override
+    {
+        if(!decoder_)
+        {
+            return 0;
+        }
+        return std::uint64_t(
+            stb_vorbis_get_samples_short_interleaved(decoder_, int(channels_), out, int(frames * channels_)));
+    }
+
+private:
+    stb_vorbis* decoder_{};
+};
+
+class mp3_cursor : public decoder_cursor
+{
+public:
+    mp3_cursor(const std::uint8_t* data, std::size_t data_size, const sound_info& info)
+        : decoder_cursor(info)
+        , data_(data)
+        , data_size_(data_size)
+    {
+        mp3dec_init(&decoder_);
+    }
+
+protected:
+    auto seek_to_frame(std::uint64_t frame) -> bool override
+    {
+        if(frame == 0)
+        {
+            mp3dec_init(&decoder_);
+            pos_ = pcm_pos_ = pcm_count_ = 0;
+            skip_ = 0;
+            return true;
+        }
+
+        // minimp3 has no seeking of its own, so index the frames once
+        if(index_.empty())
+        {
+            mp3dec_frame_info_t fi{};
+            index_mp3(data_, data_size_, &index_, fi);
+        }
+
+        auto it = std::upper_bound(std::begin(index_), std::end(index_), frame,
+                                   [](std::uint64_t f, const mp3_frame& e) { return f < e.first; });
+        if(it == std::begin(index_))
+        {
+            return false;
+        }
+        --it;
+
+        // start some frames earlier to fill the bit reservoir which may reach
+        // back up to 511 bytes, plus one frame decoded with it to settle the
+        // filter banks. What they decode is discarded.
+        auto target_pos = it->pos;
+        while(it != std::begin(index_) && target_pos - it->pos < max_reservoir_bytes)
+        {
+            --it;
+        }
+        for(int i = 0; i < 2 && it != std::begin(index_); ++i)
+        {
+            --it;
+        }
+
+        mp3dec_init(&decoder_);
+        pos_ = it->pos;
+        pcm_pos_ = pcm_count_ = 0;
+        skip_ = frame - it->first;
+        return true;
+    }
+
+    auto decode(std::int16_t* out, std::uint64_t frames) -> std::uint64_t override
+    {
+        std::uint64_t read = 0;
+        while(read < frames)
+        {
+            if(pcm_pos_ == pcm_count_ && !decode_frame())
+            {
+                break;
+            }
+
+            auto available = std::uint64_t(pcm_count_ - pcm_pos_);
+            if(skip_ > 0)
+            {
+                auto skipped = std::min(skip_, available);
+                pcm_pos_ += size_t(skipped);
+                skip_ -= skipped;
+                continue;
+            }
+
+            auto count = std::min(frames - read, available);
+            std::memcpy(out + read * channels_, pcm_ + pcm_pos_ * channels_,
+                        size_t(count) * get_frame_size());
+            pcm_pos_ += size_t(count);
+            read += count;
+        }
+        return read;
+    }
+
+private:
+    auto decode_frame() -> bool
+    {
+        while(pos_ < data_size_)
+        {
+            mp3dec_frame_info_t fi{};
+            auto samples = mp3dec_decode_frame(&decoder_, data_ + pos_, int(data_size_ - pos_), pcm_, &fi);
+            if(fi.frame_bytes == 0)
+            {
+                break;
+            }
+            pos_ += std::size_t(fi.frame_bytes);
+
+            if(samples == 0 && fi.hz != 0)
+            {
+                // a frame missing its bit reservoir right after seeking.
+                // Keep the timeline of the index, it gets discarded anyway.
+                samples = get_frame_samples(fi);
+                std::fill_n(pcm_, samples * fi.channels, mp3d_sample_t(0));
+            }
+
+            if(samples > 0)
+            {
+                pcm_pos_ = 0;
+                pcm_count_ = size_t(samples);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const std::uint8_t* data_{};
+    std::size_t data_size_{};
+    std::size_t pos_{};
+    mp3dec_t decoder_{};
+    /// the last decoded frame
+    mp3d_sample_t pcm_[MINIMP3_MAX_SAMPLES_PER_FRAME]{};
+    size_t pcm_pos_{};
+    size_t pcm_count_{};
+    /// frames to discard after a seek
+    std::uint64_t skip_{};
+    std::vector<mp3_frame> index_;
+};
+
+} // namespace
+
+auto probe_encoded(const std::uint8_t* data, std::size_t data_size, sound_info& info, sound_codec& codec,
+                   std::string& err) -> bool
+{
+    if(auto wav = drwav_open_memory(data, data_size))
+    {
+        fill_info(info, wav->channels, wav->sampleRate, wav->totalPCMFrameCount);
+        codec = sound_codec::wav;
+        drwav_close(wav);
+        return has_frames(info, err);
+    }
+
+    int vorb_err = 0;
+    if(auto ogg = stb_vorbis_open_memory(data, int(data_size), &vorb_err, nullptr))
+    {
+        auto ogg_info = stb_vorbis_get_info(ogg);
+        fill_info(info, std::uint32_t(ogg_info.channels), ogg_info.sample_rate,
+                  stb_vorbis_stream_length_in_samples(ogg));
+        codec = sound_codec::ogg;
+        stb_vorbis_close(ogg);
+        return has_frames(info, err);
+    }
+
+    if(auto flac = drflac_open_memory(data, data_size))
+    {
+        fill_info(info, flac->channels, flac->sampleRate, flac->totalPCMFrameCount);
+        codec = sound_codec::flac;
+        drflac_close(flac);
+        return has_frames(info, err);
+    }
+
+    // mp3 has no header to check, so it is tried last
+    mp3dec_frame_info_t fi{};
+    auto frames = index_mp3(data, data_size, nullptr, fi);
+    if(frames != 0)
+    {
+        fill_info(info, std::uint32_t(fi.channels), std::uint32_t(fi.hz), frames);
+        codec = sound_codec::mp3;
+        return true;
+    }
+
+    err = "Unsupported or corrupted encoded data.";
+    return false;
+}
+
+auto create_decoder_cursor(const std::uint8_t* data, std::size_t data_size, sound_codec codec,
+                           const sound_info& info) -> std::unique_ptr<stream_cursor>
+{
+    switch(codec)
+    {
+        case sound_codec::wav:
+            return std::make_unique<wav_cursor>(data, data_size, info);
+        case sound_codec::ogg:
+            return std::make_unique<ogg_cursor>(data, data_size, info);
+        case sound_codec::mp3:
+            return std::make_unique<mp3_cursor>(data, data_size, info);
+        case sound_codec::flac:
+            return std::make_unique<flac_cursor>(data, data_size, info);
+    }
+    return nullptr;
+}
+
+} // namespace detail
+} // namespace audio
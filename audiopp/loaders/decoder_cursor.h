@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../impl/stream_cursor.h"
+#include "../sound_data.h"
+
+#include <memory>
+#include <string>
+
+namespace audio
+{
+namespace detail
+{
+
+//-----------------------------------------------------------------------------
+/// Reads the sound info of encoded data without decoding it.
+//-----------------------------------------------------------------------------
+auto probe_encoded(const std::uint8_t* data, std::size_t data_size, sound_info& info, sound_codec& codec,
+                   std::string& err) -> bool;
+
+//-----------------------------------------------------------------------------
+/// Creates a cursor decoding the data as it is read. The data must outlive it.
+//-----------------------------------------------------------------------------
+auto create_decoder_cursor(const std::uint8_t* data, std::size_t data_size, sound_codec codec,
+                           const sound_info& info) -> std::unique_ptr<stream_cursor>;
+
+} // namespace detail
+} // namespace audio
@@ -1,4 +1,5 @@
 #include "loader.h"
+#include "decoder_cursor.h"
 
 #include "../sound_data.h"
 
@@ -129,6 +130,45 @@ auto load_from_memory(const uint8_t* data, size_t size, sound_data& result, std:
     return success;
 }
 
+auto load_encoded_from_memory(const std::uint8_t* data, std::size_t data_size, encoded_sound_data& result,
+                              std::string& err) -> bool
+{
+    if(!data || !data_size)
+    {
+        err = "No data to load from.";
+        return false;
+    }
+
+    if(!detail::probe_encoded(data, data_size, result.info, result.codec, err))
+    {
+        return false;
+    }
+
+    result.data.assign(data, data + data_size);
+    err = {};
+    return true;
+}
+
+auto load_encoded_from_file(const std::string& path, encoded_sound_data& result, std::string& err) -> bool
+{
+    byte_array_t buffer;
+    if(!load_file(path, buffer))
+    {
+        err = "Failed to load file : " + path;
+        return false;
+    }
+
+    if(!detail::probe_encoded(buffer.data(), buffer.size(), result.info, result.codec, err))
+    {
+        return false;
+    }
+
+    result.data = std::move(buffer);
+    result.info.id = path;
+    err = {};
+    return true;
+}
+
 auto load_from_file_ogg(const std::string& path, sound_data& result, std::string& err) -> bool
 {
     return load_from_file_impl(load_from_memory_ogg, path, result, err);
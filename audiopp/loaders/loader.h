@@ -6,6 +6,7 @@ namespace audio
 {
 
 struct sound_data;
+struct encoded_sound_data;
 
 auto load_from_memory_ogg(const std::uint8_t* data, std::size_t data_size, sound_data& result,
                           std::string& err) -> bool;
@@ -23,4 +24,12 @@ auto load_from_file_wav(const std::string& path, sound_data& result, std::string
 auto load_from_file_mp3(const std::string& path, sound_data& result, std::string& err) -> bool;
 auto load_from_file_flac(const std::string& path, sound_data& result, std::string& err) -> bool;
 auto load_from_file(const std::string& path, sound_data& result, std::string& err) -> bool;
+
+//-----------------------------------------------------------------------------
+/// Keeps the data encoded, only probing it for the sound info. Such sounds
+/// are decoded just in time while they play.
+//-----------------------------------------------------------------------------
+auto load_encoded_from_memory(const std::uint8_t* data, std::size_t data_size, encoded_sound_data& result,
+                              std::string& err) -> bool;
+auto load_encoded_from_file(const std::string& path, encoded_sound_data& result, std::string& err) -> bool;
 } // namespace audio
@@ -0,0 +1,79 @@
+#include "loopback_device.h"
+#include "impl/device_impl.h"
+
+namespace audio
+{
+
+loopback_device::loopback_device(const render_format& format)
+    : impl_(std::make_unique<detail::device_impl>(format))
+{
+}
+
+loopback_device::~loopback_device() = default;
+
+void loopback_device::enable()
+{
+    if(impl_)
+    {
+        impl_->enable();
+    }
+}
+
+void loopback_device::disable()
+{
+    if(impl_)
+    {
+        impl_->disable();
+    }
+}
+
+void loopback_device::begin_update()
+{
+    if(impl_)
+    {
+        impl_->begin_update();
+    }
+}
+
+void loopback_device::end_update()
+{
+    if(impl_)
+    {
+        impl_->end_update();
+    }
+}
+
+auto loopback_device::is_valid() const -> bool
+{
+    return impl_ && impl_->is_valid();
+}
+
+auto loopback_device::get_format() const -> const render_format&
+{
+    return impl_->get_render_format();
+}
+
+auto loopback_device::get_frame_size() const -> size_t
+{
+    return impl_ ? impl_->get_render_frame_size() : 0;
+}
+
+void loopback_device::render(size_t frames, void* out_buffer)
+{
+    if(impl_)
+    {
+        impl_->render(frames, out_buffer);
+    }
+}
+
+auto loopback_device::is_supported() -> bool
+{
+    detail::loopback_extension ext;
+    return detail::load_loopback_extension(ext);
+}
+
+auto loopback_device::is_format_supported(const render_format& format) -> bool
+{
+    return detail::device_impl::is_render_format_supported(format);
+}
+} // namespace audio
@@ -0,0 +1,106 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace audio
+{
+namespace detail
+{
+class device_impl;
+}
+
+enum class render_type : std::uint8_t
+{
+    int16,
+    float32
+};
+
+struct render_format
+{
+    /// frames per second
+    std::uint32_t sample_rate{44100};
+
+    /// interleaved channels. 1, 2, 4, 6, 7 or 8 for 5.1, 6.1 and 7.1
+    std::uint8_t channels{2};
+
+    /// type of each sample
+    render_type type{render_type::int16};
+};
+
+//-----------------------------------------------------------------------------
+/// Audio device mixing into memory instead of playing through the hardware,
+/// over ALC_SOFT_loopback. Nothing is mixed until render is called, as fast as
+/// the CPU allows. Useful on machines without audio hardware, to compare the
+/// output against references or to bounce mixes to files. Used in place of
+/// the device, only one of them may exist at a time.
+//-----------------------------------------------------------------------------
+class loopback_device
+{
+public:
+    //-----------------------------------------------------------------------------
+    /// Creates a loopback device and context rendering in the format.
+    /// Throws if the extension or the format is not supported.
+    //-----------------------------------------------------------------------------
+    loopback_device(const render_format& format = {});
+    ~loopback_device();
+
+    //-----------------------------------------------------------------------------
+    /// Sets the current context.
+    //-----------------------------------------------------------------------------
+    void enable();
+
+    //-----------------------------------------------------------------------------
+    /// Un - sets the current context.
+    //-----------------------------------------------------------------------------
+    void disable();
+
+    //-----------------------------------------------------------------------------
+    /// Starts collecting the property changes of sources and the listener.
+    /// See device::begin_update
+    //-----------------------------------------------------------------------------
+    void begin_update();
+
+    //-----------------------------------------------------------------------------
+    /// Commits the property changes collected since begin_update.
+    //-----------------------------------------------------------------------------
+    void end_update();
+
+    //-----------------------------------------------------------------------------
+    /// Checks whether the device and context are valid.
+    //-----------------------------------------------------------------------------
+    auto is_valid() const -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Gets the format the device renders in.
+    //-----------------------------------------------------------------------------
+    auto get_format() const -> const render_format&;
+
+    //-----------------------------------------------------------------------------
+    /// Gets the size of a frame, all the channels of one sample, in bytes.
+    //-----------------------------------------------------------------------------
+    auto get_frame_size() const -> size_t;
+
+    //-----------------------------------------------------------------------------
+    /// Mixes the next frames into the buffer, which must hold frames times the
+    /// frame size bytes. The sources advance by as much, call system::update
+    /// with the rendered duration in between to keep the streams fed.
+    //-----------------------------------------------------------------------------
+    void render(size_t frames, void* out_buffer);
+
+    //-----------------------------------------------------------------------------
+    /// Checks whether ALC_SOFT_loopback is available.
+    //-----------------------------------------------------------------------------
+    static auto is_supported() -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Checks whether the device can render in the format.
+    //-----------------------------------------------------------------------------
+    static auto is_format_supported(const render_format& format) -> bool;
+
+private:
+    /// pimpl idiom
+    std::unique_ptr<detail::device_impl> impl_;
+};
+} // namespace audio
@@ -0,0 +1,36 @@
+#include "oneshot.h"
+#include "impl/oneshot_pool.h"
+
+namespace audio
+{
+
+auto play_oneshot(const sound& snd, const oneshot_params& params) -> bool
+{
+    return detail::oneshot_pool::play(snd, params);
+}
+
+auto play_oneshot(const sound_handle& snd, const oneshot_params& params) -> bool
+{
+    return detail::oneshot_pool::play(snd, params);
+}
+
+void stop_oneshots()
+{
+    detail::oneshot_pool::stop_all();
+}
+
+void set_max_oneshots(std::size_t count)
+{
+    detail::oneshot_pool::set_max_oneshots(count);
+}
+
+auto get_max_oneshots() -> std::size_t
+{
+    return detail::oneshot_pool::get_max_oneshots();
+}
+
+auto get_oneshot_stats() -> oneshot_stats
+{
+    return detail::oneshot_pool::get_stats();
+}
+} // namespace audio
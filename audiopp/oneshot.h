@@ -0,0 +1,83 @@
+#pragma once
+
+#include "sound.h"
+#include "types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace audio
+{
+
+struct oneshot_params
+{
+    /// the location in three dimensional space
+    float3 position{};
+
+    /// 1.0 means unattenuated, see source::set_volume
+    float volume{1.0f};
+
+    /// multiplier for the frequency of the sound, see source::set_pitch
+    float pitch{1.0f};
+
+    /// multiplier of the distance attenuation, see source::set_volume_rolloff
+    float rolloff{1.0f};
+
+    /// the distances the attenuation starts and stops at, see source::set_distance
+    float min_distance{1.0f};
+    float max_distance{std::numeric_limits<float>::max()};
+
+    /// used to hand out the real voices, see source::set_priority
+    int priority{};
+};
+
+struct oneshot_stats
+{
+    /// how many one-shots may play at once
+    std::uint64_t max_oneshots{};
+
+    /// sources created for the pool so far
+    std::uint64_t pooled{};
+
+    /// one-shots playing at the moment
+    std::uint64_t playing{};
+
+    /// one-shots started
+    std::uint64_t played{};
+
+    /// one-shots not started because the pool was exhausted
+    std::uint64_t dropped{};
+};
+
+//-----------------------------------------------------------------------------
+/// Plays the sound once on a source drawn from an internal pool. The source
+/// goes back to the pool on its own once the sound played to its end, which
+/// is noticed by system::update. Nothing is allocated once the pool has grown.
+/// Returns false if all of the pool is playing already or the sound can't be
+/// bound.
+//-----------------------------------------------------------------------------
+auto play_oneshot(const sound& snd, const oneshot_params& params = {}) -> bool;
+auto play_oneshot(const sound_handle& snd, const oneshot_params& params = {}) -> bool;
+
+//-----------------------------------------------------------------------------
+/// Stops all the one-shots playing and returns their sources to the pool.
+//-----------------------------------------------------------------------------
+void stop_oneshots();
+
+//-----------------------------------------------------------------------------
+/// Sets how many one-shots may play at once, which bounds how far the pool
+/// grows.
+//-----------------------------------------------------------------------------
+void set_max_oneshots(std::size_t count);
+
+//-----------------------------------------------------------------------------
+/// Gets how many one-shots may play at once.
+//-----------------------------------------------------------------------------
+auto get_max_oneshots() -> std::size_t;
+
+//-----------------------------------------------------------------------------
+/// Gets the counters of the one-shot pool.
+//-----------------------------------------------------------------------------
+auto get_oneshot_stats() -> oneshot_stats;
+} // namespace audio
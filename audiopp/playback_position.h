@@ -0,0 +1,61 @@
+#pragma once
+
+#include "types.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+namespace audio
+{
+
+//-----------------------------------------------------------------------------
+/// Playback position of a source, exact to the sample and with the time it
+/// still takes for the mixed samples to be heard.
+//-----------------------------------------------------------------------------
+struct playback_position
+{
+    /// frames played from the start of the sound, as 32.32 fixed point
+    std::int64_t frames{};
+
+    /// frames per second of the bound sound
+    std::uint32_t sample_rate{};
+
+    /// time of the device clock the position was taken at,
+    /// zero if the device clock is not available
+    std::chrono::nanoseconds device_time{};
+
+    /// how long it takes for the frame being mixed to be heard
+    std::chrono::nanoseconds latency{};
+
+    //-----------------------------------------------------------------------------
+    /// Gets the whole frame being mixed.
+    //-----------------------------------------------------------------------------
+    auto get_frame() const -> std::int64_t
+    {
+        return frames >> 32;
+    }
+
+    //-----------------------------------------------------------------------------
+    /// Gets the position of the frame being mixed, in seconds.
+    //-----------------------------------------------------------------------------
+    auto get_mixed_time() const -> duration_t
+    {
+        if(sample_rate == 0)
+        {
+            return duration_t::zero();
+        }
+        return duration_t(double(frames) / 4294967296.0 / double(sample_rate));
+    }
+
+    //-----------------------------------------------------------------------------
+    /// Gets the position of the frame being heard, in seconds. This is the
+    /// one to synchronize with, e.g. for rhythm games or lip-sync.
+    //-----------------------------------------------------------------------------
+    auto get_heard_time() const -> duration_t
+    {
+        auto time = get_mixed_time() - std::chrono::duration_cast<duration_t>(latency);
+        return std::max(time, duration_t::zero());
+    }
+};
+} // namespace audio
@@ -0,0 +1,136 @@
+#include "playlist.h"
+#include "impl/playlist_impl.h"
+
+namespace audio
+{
+playlist::playlist()
+    : impl_(std::make_unique<detail::playlist_impl>())
+{
+}
+
+playlist::~playlist() = default;
+
+playlist::playlist(playlist&& rhs) noexcept = default;
+
+playlist& playlist::operator=(playlist&& rhs) noexcept = default;
+
+void playlist::add(const sound_handle& snd)
+{
+    if(impl_)
+    {
+        impl_->add(snd);
+    }
+}
+
+void playlist::clear()
+{
+    if(impl_)
+    {
+        impl_->clear();
+    }
+}
+
+auto playlist::get_track_count() const -> size_t
+{
+    return impl_ ? impl_->get_track_count() : 0;
+}
+
+auto playlist::get_current_track() const -> size_t
+{
+    return impl_ ? impl_->get_current_track() : 0;
+}
+
+void playlist::set_crossfade(duration_t duration)
+{
+    if(impl_)
+    {
+        impl_->set_crossfade(duration);
+    }
+}
+
+auto playlist::get_crossfade() const -> duration_t
+{
+    return impl_ ? impl_->get_crossfade() : duration_t::zero();
+}
+
+void playlist::set_loop(bool on)
+{
+    if(impl_)
+    {
+        impl_->set_loop(on);
+    }
+}
+
+auto playlist::is_looping() const -> bool
+{
+    return impl_ ? impl_->is_looping() : false;
+}
+
+void playlist::set_volume(float volume)
+{
+    if(impl_)
+    {
+        impl_->set_volume(volume);
+    }
+}
+
+auto playlist::get_volume() const -> float
+{
+    return impl_ ? impl_->get_volume() : 0.0f;
+}
+
+void playlist::play()
+{
+    if(impl_)
+    {
+        impl_->play();
+    }
+}
+
+void playlist::play_track(size_t index)
+{
+    if(impl_)
+    {
+        impl_->play_track(index);
+    }
+}
+
+void playlist::next()
+{
+    if(impl_)
+    {
+        impl_->next();
+    }
+}
+
+void playlist::stop()
+{
+    if(impl_)
+    {
+        impl_->stop();
+    }
+}
+
+void playlist::pause()
+{
+    if(impl_)
+    {
+        impl_->pause();
+    }
+}
+
+auto playlist::is_playing() const -> bool
+{
+    return impl_ ? impl_->is_playing() : false;
+}
+
+auto playlist::is_paused() const -> bool
+{
+    return impl_ ? impl_->is_paused() : false;
+}
+
+auto playlist::get_source(size_t index) -> source&
+{
+    return impl_->get_source(index);
+}
+} // namespace audio
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "sound.h"
+#include "source.h"
+#include "types.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace audio
+{
+namespace detail
+{
+class playlist_impl;
+}
+
+//-----------------------------------------------------------------------------
+/// Plays sounds one after the other, e.g. the tracks of the music. Tracks are
+/// queued on the same source ahead of time and follow each other without a
+/// gap, or crossfade over two sources when a crossfade is set. The playlist
+/// moves on with system::update.
+//-----------------------------------------------------------------------------
+class playlist
+{
+public:
+    playlist();
+    ~playlist();
+    playlist(playlist&& rhs) noexcept;
+    playlist& operator=(playlist&& rhs) noexcept;
+
+    playlist(const playlist& rhs) = delete;
+    playlist& operator=(const playlist& rhs) = delete;
+
+    //-----------------------------------------------------------------------------
+    /// Adds the sound after the last track. Gapless playback needs all the
+    /// tracks to share the format and be either all streamed or all static,
+    /// otherwise there is a short gap between the tracks which differ.
+    //-----------------------------------------------------------------------------
+    void add(const sound_handle& snd);
+
+    //-----------------------------------------------------------------------------
+    /// Stops and removes all the tracks.
+    //-----------------------------------------------------------------------------
+    void clear();
+
+    //-----------------------------------------------------------------------------
+    /// Gets how many tracks there are.
+    //-----------------------------------------------------------------------------
+    auto get_track_count() const -> size_t;
+
+    //-----------------------------------------------------------------------------
+    /// Gets the index of the track being played, or the one played next.
+    //-----------------------------------------------------------------------------
+    auto get_current_track() const -> size_t;
+
+    //-----------------------------------------------------------------------------
+    /// Fades each track out while the next one fades in over the duration,
+    /// keeping the loudness even. Zero, the default, plays the tracks back to
+    /// back without a gap.
+    //-----------------------------------------------------------------------------
+    void set_crossfade(duration_t duration);
+
+    //-----------------------------------------------------------------------------
+    /// Gets how long the tracks crossfade for.
+    //-----------------------------------------------------------------------------
+    auto get_crossfade() const -> duration_t;
+
+    //-----------------------------------------------------------------------------
+    /// Starts over from the first track once the last one was played.
+    //-----------------------------------------------------------------------------
+    void set_loop(bool on);
+
+    //-----------------------------------------------------------------------------
+    /// Checks whether the playlist starts over once played.
+    //-----------------------------------------------------------------------------
+    auto is_looping() const -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Sets the volume the tracks are played at.
+    //-----------------------------------------------------------------------------
+    void set_volume(float volume);
+
+    //-----------------------------------------------------------------------------
+    /// Gets the volume the tracks are played at.
+    //-----------------------------------------------------------------------------
+    auto get_volume() const -> float;
+
+    //-----------------------------------------------------------------------------
+    /// Plays the current track, or resumes it if paused.
+    //-----------------------------------------------------------------------------
+    void play();
+
+    //-----------------------------------------------------------------------------
+    /// Plays the track from its start, crossfading from the one playing.
+    //-----------------------------------------------------------------------------
+    void play_track(size_t index);
+
+    //-----------------------------------------------------------------------------
+    /// Moves on to the next track right away, crossfading if set. Stops after
+    /// the last track unless looping.
+    //-----------------------------------------------------------------------------
+    void next();
+
+    //-----------------------------------------------------------------------------
+    /// Stops playing, the current track starts over when played again.
+    //-----------------------------------------------------------------------------
+    void stop();
+
+    //-----------------------------------------------------------------------------
+    /// Pauses the tracks playing.
+    //-----------------------------------------------------------------------------
+    void pause();
+
+    //-----------------------------------------------------------------------------
+    /// Checks whether the playlist is playing.
+    //-----------------------------------------------------------------------------
+    auto is_playing() const -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Checks whether the playlist is paused.
+    //-----------------------------------------------------------------------------
+    auto is_paused() const -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Gets one of the two sources the tracks are played on, e.g. to put them
+    /// into a bus or to place them. They take turns when crossfading. Their
+    /// volumes and stopped callbacks are used by the playlist.
+    //-----------------------------------------------------------------------------
+    auto get_source(size_t index) -> source&;
+
+private:
+    /// pimpl idiom
+    std::unique_ptr<detail::playlist_impl> impl_;
+};
+} // namespace audio
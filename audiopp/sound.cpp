@@ -4,12 +4,33 @@
 namespace audio
 {
 
+namespace
+{
+auto get_empty_info() -> const sound_info&
+{
+    static sound_info empty;
+    return empty;
+}
+
+auto make_sound_impl(sound_data&& data, bool stream) -> std::shared_ptr<detail::sound_impl>
+{
+    // the impl may be released from any thread holding a handle
+    return {new detail::sound_impl(std::move(data.data), std::move(data.info), stream),
+            &detail::sound_impl::release};
+}
+} // namespace
+
 sound::sound() = default;
 
 sound::~sound() = default;
 
 sound::sound(sound_data&& data, bool stream)
-    : impl_(std::make_unique<detail::sound_impl>(std::move(data.data), std::move(data.info), stream))
+    : impl_(make_sound_impl(std::move(data), stream))
+{
+}
+
+sound::sound(encoded_sound_data&& data)
+    : impl_(new detail::sound_impl(std::move(data)), &detail::sound_impl::release)
 {
 }
 
@@ -27,21 +48,132 @@ auto sound::get_info() const -> const sound_info&
     {
         return impl_->get_info();
     }
-    static sound_info empty;
-    return empty;
+    return get_empty_info();
+}
+
+auto sound::append_chunk(std::vector<uint8_t>&& data) -> bool
+{
+    return impl_ && impl_->append_chunk(std::move(data));
+}
+
+void sound::open_feed(size_t capacity, underrun_policy policy)
+{
+    if(impl_)
+    {
+        impl_->open_feed(capacity, policy);
+    }
 }
 
-void sound::append_chunk(std::vector<uint8_t>&& data)
+void sound::close_feed()
 {
     if(impl_)
     {
-        impl_->append_chunk(std::move(data));
+        impl_->close_feed();
     }
 }
 
+auto sound::get_feed_stats() const -> feed_stats
+{
+    return impl_ ? impl_->get_feed_stats() : feed_stats{};
+}
+
+void sound::set_reload_recipe(reload_recipe recipe)
+{
+    if(impl_)
+    {
+        impl_->set_reload_recipe(std::move(recipe));
+    }
+}
+
+auto sound::set_loop_points(std::uint64_t start_frame, std::uint64_t end_frame) -> bool
+{
+    if(impl_)
+    {
+        return impl_->set_loop_points(start_frame, end_frame);
+    }
+    return false;
+}
+
+auto sound::get_loop_start() const -> std::uint64_t
+{
+    if(impl_)
+    {
+        return impl_->get_loop_start();
+    }
+    return 0;
+}
+
+auto sound::get_loop_end() const -> std::uint64_t
+{
+    if(impl_)
+    {
+        return impl_->get_loop_end();
+    }
+    return 0;
+}
+
 auto sound::uid() const -> uintptr_t
 {
     return reinterpret_cast<uintptr_t>(impl_.get());
 }
 
+auto sound::share() const -> sound_handle
+{
+    sound_handle handle;
+    handle.impl_ = impl_;
+    return handle;
+}
+
+sound_handle::sound_handle(sound&& snd) noexcept
+    : impl_(std::move(snd.impl_))
+{
+}
+
+auto sound_handle::is_valid() const -> bool
+{
+    return impl_ && impl_->is_valid();
+}
+
+auto sound_handle::get_info() const -> const sound_info&
+{
+    if(impl_)
+    {
+        return impl_->get_info();
+    }
+    return get_empty_info();
+}
+
+auto sound_handle::uid() const -> uintptr_t
+{
+    return reinterpret_cast<uintptr_t>(impl_.get());
+}
+
+auto sound_handle::use_count() const -> long
+{
+    return impl_.use_count();
+}
+
+auto sound_handle::append_chunk(std::vector<uint8_t>&& data) const -> bool
+{
+    return impl_ && impl_->append_chunk(std::move(data));
+}
+
+void sound_handle::close_feed() const
+{
+    if(impl_)
+    {
+        impl_->close_feed();
+    }
+}
+
+auto sound_handle::get_feed_stats() const -> feed_stats
+{
+    return impl_ ? impl_->get_feed_stats() : feed_stats{};
+}
+
+void sound_handle::reset()
+{
+    impl_.reset();
+}
+
 } // namespace audio
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "sound_data.h"
+#include "sound_feed.h"
 #include <memory>
 
 namespace audio
@@ -10,6 +11,8 @@ namespace detail
 class sound_impl;
 }
 
+class sound_handle;
+
 //-----------------------------------------------------------------------------
 /// Storage for audio samples defining a sound.
 //-----------------------------------------------------------------------------
@@ -19,6 +22,12 @@ public:
     sound();
     ~sound();
     sound(sound_data&& data, bool stream = false);
+
+    //-----------------------------------------------------------------------------
+    /// Keeps the data encoded and decodes it just in time while playing, each
+    /// source with a cursor of its own. Such sounds are always streamed.
+    //-----------------------------------------------------------------------------
+    sound(encoded_sound_data&& data);
     sound(sound&& rhs) noexcept;
     sound& operator=(sound&& rhs) noexcept;
 
@@ -36,19 +45,137 @@ public:
     auto get_info() const -> const sound_info&;
 
     //-----------------------------------------------------------------------------
-    /// Adds a pcm data chunk
+    /// Adds a pcm data chunk. While a feed is open it can be called from the
+    /// producer thread and returns false if the chunk was rejected because
+    /// the feed is full or closed.
+    //-----------------------------------------------------------------------------
+    auto append_chunk(std::vector<uint8_t>&& data) -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Opens a feed letting a single producer thread append chunks without
+    /// locking. Up to 'capacity' chunks can be in flight until the context
+    /// thread takes them over. Must be called before the producer starts.
+    //-----------------------------------------------------------------------------
+    void open_feed(size_t capacity, underrun_policy policy = underrun_policy::wait);
+
+    //-----------------------------------------------------------------------------
+    /// Signals that the producer is done. Sources stop once they play what was fed.
+    //-----------------------------------------------------------------------------
+    void close_feed();
+
+    //-----------------------------------------------------------------------------
+    /// Gets the counters of the feed.
+    //-----------------------------------------------------------------------------
+    auto get_feed_stats() const -> feed_stats;
+
+    //-----------------------------------------------------------------------------
+    /// Sets how to load the data again. Only sounds having one can be evicted
+    /// when the memory budget is exceeded, they are reloaded on the next bind.
+    /// Sounds kept encoded are never evicted. The data reloaded must have the
+    /// same format and length, otherwise it is rejected.
+    //-----------------------------------------------------------------------------
+    void set_reload_recipe(reload_recipe recipe);
+
+    //-----------------------------------------------------------------------------
+    /// Sets the frames a looping source loops over, so that an intro plays
+    /// once before the loop. An end of 0 is the end of the sound. Static sounds
+    /// need AL_SOFT_loop_points and can't change them while bound to or queued
+    /// on sources, streamed sounds jump back to the loop start when refilling
+    /// their buffers. Returns whether sources will loop over them, a static
+    /// sound split into several buffers loops as a whole.
+    //-----------------------------------------------------------------------------
+    auto set_loop_points(std::uint64_t start_frame, std::uint64_t end_frame = 0) -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Gets the frame the loop starts at.
     //-----------------------------------------------------------------------------
-    void append_chunk(std::vector<uint8_t>&& data);
+    auto get_loop_start() const -> std::uint64_t;
+
+    //-----------------------------------------------------------------------------
+    /// Gets the frame the loop ends at.
+    //-----------------------------------------------------------------------------
+    auto get_loop_end() const -> std::uint64_t;
 
     //-----------------------------------------------------------------------------
     /// Unique identifier of this sound. 0 is invalid
     //-----------------------------------------------------------------------------
     auto uid() const -> uintptr_t;
 
+    //-----------------------------------------------------------------------------
+    /// Creates a handle sharing the ownership of this sound's samples.
+    /// The samples are released once this sound and all of the handles are gone.
+    //-----------------------------------------------------------------------------
+    auto share() const -> sound_handle;
+
 private:
+    friend class sound_handle;
     friend class source;
 
     /// pimpl idiom
-    std::unique_ptr<detail::sound_impl> impl_;
+    std::shared_ptr<detail::sound_impl> impl_;
+};
+
+//-----------------------------------------------------------------------------
+/// Cheap, copyable reference to a sound. Copying it does not duplicate any
+/// samples or buffers and handles can be copied and released from any thread.
+/// Releasing the last reference unbinds the sound from all sources and frees
+/// its buffers.
+//-----------------------------------------------------------------------------
+class sound_handle
+{
+public:
+    sound_handle() = default;
+
+    //-----------------------------------------------------------------------------
+    /// Takes over the ownership of the sound.
+    //-----------------------------------------------------------------------------
+    sound_handle(sound&& snd) noexcept;
+
+    //-----------------------------------------------------------------------------
+    /// Checks whether the referenced sound is valid.
+    //-----------------------------------------------------------------------------
+    auto is_valid() const -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Gets the referenced sound's data info.
+    //-----------------------------------------------------------------------------
+    auto get_info() const -> const sound_info&;
+
+    //-----------------------------------------------------------------------------
+    /// Unique identifier of the referenced sound. 0 is invalid
+    //-----------------------------------------------------------------------------
+    auto uid() const -> uintptr_t;
+
+    //-----------------------------------------------------------------------------
+    /// Gets how many sounds and handles share the referenced sound.
+    //-----------------------------------------------------------------------------
+    auto use_count() const -> long;
+
+    //-----------------------------------------------------------------------------
+    /// Adds a pcm data chunk to the referenced sound. See sound::append_chunk
+    //-----------------------------------------------------------------------------
+    auto append_chunk(std::vector<uint8_t>&& data) const -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Closes the feed of the referenced sound. See sound::close_feed
+    //-----------------------------------------------------------------------------
+    void close_feed() const;
+
+    //-----------------------------------------------------------------------------
+    /// Gets the counters of the referenced sound's feed.
+    //-----------------------------------------------------------------------------
+    auto get_feed_stats() const -> feed_stats;
+
+    //-----------------------------------------------------------------------------
+    /// Releases the reference.
+    //-----------------------------------------------------------------------------
+    void reset();
+
+private:
+    friend class sound;
+    friend class source;
+
+    /// shared pimpl
+    std::shared_ptr<detail::sound_impl> impl_;
 };
 } // namespace audio
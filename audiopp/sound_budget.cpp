@@ -0,0 +1,16 @@
+#include "sound_budget.h"
+#include "impl/memory_budget.h"
+
+namespace audio
+{
+
+void set_sound_memory_budget(std::size_t bytes)
+{
+    detail::memory_budget::set_budget(bytes);
+}
+
+auto get_sound_memory_stats() -> sound_memory_stats
+{
+    return detail::memory_budget::get_stats();
+}
+} // namespace audio
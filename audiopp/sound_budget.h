@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace audio
+{
+
+struct sound_memory_stats
+{
+    /// the budget in bytes, 0 means unlimited
+    std::uint64_t budget{};
+
+    /// bytes held by all sounds in their own memory and in openal buffers
+    std::uint64_t resident_bytes{};
+
+    /// sounds bound while they were resident
+    std::uint64_t hits{};
+
+    /// evicted sounds reloaded from their recipe when bound
+    std::uint64_t reloads{};
+
+    /// sounds evicted to stay within the budget
+    std::uint64_t evictions{};
+
+    /// bytes freed by the evictions
+    std::uint64_t evicted_bytes{};
+};
+
+//-----------------------------------------------------------------------------
+/// Sets how many bytes the sounds may keep resident. Once it is exceeded the
+/// least recently bound sounds which are not bound to any source and have a
+/// reload recipe are evicted. 0 means unlimited.
+//-----------------------------------------------------------------------------
+void set_sound_memory_budget(std::size_t bytes);
+
+//-----------------------------------------------------------------------------
+/// Gets the counters of the sound memory budget.
+//-----------------------------------------------------------------------------
+auto get_sound_memory_stats() -> sound_memory_stats;
+} // namespace audio
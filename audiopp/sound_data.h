@@ -2,6 +2,7 @@
 
 #include "sound_info.h"
 #include <cstdint>
+#include <functional>
 #include <vector>
 
 namespace audio
@@ -31,4 +32,29 @@ struct sound_data
     /// info about the sound
     sound_info info;
 };
+
+enum class sound_codec : std::uint8_t
+{
+    wav,
+    ogg,
+    mp3,
+    flac
+};
+
+struct encoded_sound_data
+{
+    /// encoded bytes, e.g the contents of an ogg file
+    std::vector<std::uint8_t> data;
+
+    /// info about the decoded sound
+    sound_info info;
+
+    /// codec the data is encoded with
+    sound_codec codec{};
+};
+
+//-----------------------------------------------------------------------------
+/// Loads the data of a sound again, e.g from the file it was loaded from.
+//-----------------------------------------------------------------------------
+using reload_recipe = std::function<bool(sound_data& data)>;
 } // namespace audio
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+namespace audio
+{
+
+//-----------------------------------------------------------------------------
+/// What a streaming source does when it has played everything fed so far.
+//-----------------------------------------------------------------------------
+enum class underrun_policy
+{
+    /// keep the source alive and resume once more data is fed
+    wait,
+    /// treat it as the end of the sound and stop
+    stop
+};
+
+struct feed_stats
+{
+    /// chunks accepted from the producer
+    std::uint64_t fed_chunks{};
+
+    /// bytes accepted from the producer
+    std::uint64_t fed_bytes{};
+
+    /// chunks rejected because the feed was full or already closed
+    std::uint64_t overruns{};
+
+    /// times a source ran out of data while the feed was still open
+    std::uint64_t underruns{};
+};
+} // namespace audio
@@ -1,5 +1,8 @@
 #include "source.h"
+#include "impl/sound_impl.h"
+#include "impl/binding_registry.h"
 #include "impl/source_impl.h"
+#include "impl/source_registry.h"
 #include <cassert>
 #include "logger.h"
 
@@ -8,14 +11,13 @@ namespace audio
 source::source()
     : impl_(std::make_unique<detail::source_impl>())
 {
+    detail::source_registry::set_owner(impl_.get(), this);
 }
 
 source::~source()
 {
-    bound_effects_visitor([this](effect* e)
-    {
-        e->remove_dead_source(*this);
-    });
+    unbind_all_effects();
+    detail::binding_registry::release_source(binding_);
 }
 
 source::source(source&& rhs) noexcept
@@ -27,10 +29,8 @@ source& source::operator=(source&& rhs) noexcept
 {
     if (this != &rhs)
     {
-        bound_effects_visitor([this](effect* e)
-        {
-            e->remove_dead_source(*this);
-        });
+        unbind_all_effects();
+        detail::binding_registry::release_source(binding_);
         move(std::move(rhs));
     }
 
@@ -46,6 +46,32 @@ void source::play()
     request(&detail::source_impl::play, &effect::request_play);
 }
 
+void source::play_together(const std::vector<source*>& sources, duration_t delay)
+{
+    // reused, no allocations once grown
+    static std::vector<detail::source_impl*> impls;
+    impls.clear();
+
+    for(auto src : sources)
+    {
+        if(src == nullptr || !src->is_valid() || src->is_waiting())
+        {
+            continue;
+        }
+
+        // the effects decide when their sources start
+        if(src->has_bound_effect())
+        {
+            src->play();
+            continue;
+        }
+
+        impls.push_back(src->impl_.get());
+    }
+
+    detail::source_impl::play_together(impls, delay);
+}
+
 void source::stop()
 {
     if (is_waiting())
@@ -113,6 +139,14 @@ auto source::is_muted() const -> bool
     return false;
 }
 
+void source::refresh_state() const
+{
+    if(is_valid())
+    {
+        impl_->refresh_state();
+    }
+}
+
 auto source::is_playing() const -> bool
 {
     if(is_valid())
@@ -224,6 +258,19 @@ void source::set_distance(float mind, float maxd) const
     }
 }
 
+void source::set_direct_filter(const filter& params) const
+{
+    if(is_valid())
+    {
+        impl_->set_direct_filter(params);
+    }
+}
+
+auto source::get_direct_filter() const -> filter
+{
+    return is_valid() ? impl_->get_direct_filter() : filter{};
+}
+
 void source::set_playback_position(duration_t offset)
 {
     if(is_valid())
@@ -246,6 +293,15 @@ auto source::get_playback_position() const -> duration_t
     return duration_t::zero();
 }
 
+auto source::get_playback_position_precise() const -> playback_position
+{
+    if(is_valid())
+    {
+        return impl_->get_playback_position_precise();
+    }
+    return {};
+}
+
 auto source::get_playback_duration() const -> duration_t
 {
     if(is_valid())
@@ -265,6 +321,44 @@ auto source::get_pitch() const -> float
     return is_valid() ? impl_->get_pitch() : 0.f;
 }
 
+void source::set_priority(int priority)
+{
+    if(is_valid())
+    {
+        impl_->set_priority(priority);
+    }
+}
+
+auto source::get_priority() const -> int
+{
+    return is_valid() ? impl_->get_priority() : 0;
+}
+
+auto source::is_virtual() const -> bool
+{
+    if(is_valid())
+    {
+        return impl_->is_virtual();
+    }
+    return false;
+}
+
+void source::on_stopped(stopped_callback callback)
+{
+    if(is_valid())
+    {
+        impl_->set_on_stopped(std::move(callback));
+    }
+}
+
+void source::on_buffer_completed(buffer_completed_callback callback)
+{
+    if(is_valid())
+    {
+        impl_->set_on_buffer_completed(std::move(callback));
+    }
+}
+
 auto source::is_valid() const -> bool
 {
     return impl_ && impl_->is_valid();
@@ -272,27 +366,49 @@ auto source::is_valid() const -> bool
 
 auto source::has_bound(effect& e) const -> bool
 {
-    return bound_effects_.find(&e) != bound_effects_.end();
+    return detail::binding_registry::is_bound(binding_, e.binding_);
 }
 
 auto source::has_bound_effect() const -> bool
 {
-    return !bound_effects_.empty();
+    return !detail::binding_registry::get_effects(binding_).empty();
 }
 
 void source::update(duration_t dt)
 {
+    // sounds released on other threads are destroyed here
+    detail::sound_impl::release_pending();
+
     if (is_valid())
     {
         impl_->update_stream();
+        impl_->refresh_state();
 
-        bound_effects_visitor([this, dt](effect* e)
-        {
-            e->update(*this, dt);
-        });
+        update_effects(dt);
     }
 }
 
+void source::update_effects(duration_t dt)
+{
+    bound_effects_visitor([this, dt](effect* e)
+    {
+        e->update(*this, dt);
+    });
+}
+
+void source::set_stream_lead_time(duration_t lead_time)
+{
+    if(is_valid())
+    {
+        impl_->set_stream_lead_time(lead_time);
+    }
+}
+
+auto source::get_stream_lead_time() const -> duration_t
+{
+    return is_valid() ? impl_->get_stream_lead_time() : duration_t::zero();
+}
+
 auto source::get_bound_sound_uid() const -> uintptr_t
 {
     return impl_ ? impl_->get_bound_sound_uid() : 0;
@@ -310,10 +426,20 @@ auto source::get_bound_sound_info() const -> const sound_info&
 }
 
 void source::bind(const sound& snd)
+{
+    bind_sound(snd.impl_.get());
+}
+
+void source::bind(const sound_handle& snd)
+{
+    bind_sound(snd.impl_.get());
+}
+
+void source::bind_sound(detail::sound_impl* snd)
 {
     if(is_valid())
     {
-        if(impl_->bind(snd.impl_.get()))
+        if(impl_->bind(snd))
         {
             bound_effects_visitor([this](effect* e)
             {
@@ -331,6 +457,41 @@ void source::unbind()
     }
 }
 
+auto source::queue(const sound& snd) -> bool
+{
+    if(is_valid())
+    {
+        return impl_->queue_sound(snd.impl_.get());
+    }
+    return false;
+}
+
+auto source::queue(const sound_handle& snd) -> bool
+{
+    if(is_valid())
+    {
+        return impl_->queue_sound(snd.impl_.get());
+    }
+    return false;
+}
+
+void source::clear_queue()
+{
+    if(is_valid())
+    {
+        impl_->clear_queued_sounds();
+    }
+}
+
+auto source::get_queued_sound_count() const -> size_t
+{
+    if(is_valid())
+    {
+        return impl_->get_queued_sound_count();
+    }
+    return 0;
+}
+
 auto source::has_bound_sound() const -> bool
 {
     if(is_valid())
@@ -349,47 +510,48 @@ void source::move(source&& rhs) noexcept
     });
 
     impl_ = std::move(rhs.impl_);
+    if(impl_)
+    {
+        detail::source_registry::set_owner(impl_.get(), this);
+    }
 
     assert(!is_iterating_bound_effects_ && !rhs.is_iterating_bound_effects_);
-    bound_effects_ = std::move(rhs.bound_effects_);
+
+    // the bindings refer to the slot, only the slot has to know the new address
+    binding_ = rhs.binding_;
+    rhs.binding_ = {};
+    detail::binding_registry::relocate(binding_, this);
+
     has_pending_request_ = rhs.has_pending_request_;
     ready_effects_count_ = rhs.ready_effects_count_;
     is_iterating_bound_effects_ = rhs.is_iterating_bound_effects_;
 }
 
-void source::bind_effect(effect* e) noexcept
-{
-    assert(e);
-    assert(!is_iterating_bound_effects_);
-    bound_effects_.insert(e);
-}
-
-void source::unbind_effect(effect* e) noexcept
+void source::unbind_all_effects() noexcept
 {
     assert(!is_iterating_bound_effects_);
-    bound_effects_.erase(e);
-}
 
-void source::change_effect_address(effect* from, effect* to) noexcept
-{
-    assert(from && to);
-    auto it = bound_effects_.find(from);
-    if (it != bound_effects_.end())
+    // unbinding swaps the last link into the freed position, so pop from the back.
+    // The list is fetched again each time, unbinding may grow the registry.
+    while(!detail::binding_registry::get_effects(binding_).empty())
     {
-        assert(!is_iterating_bound_effects_);
-        bound_effects_.erase(it);
-        assert(bound_effects_.find(to) == bound_effects_.end());
-        bound_effects_.insert(to);
+        const auto& links = detail::binding_registry::get_effects(binding_);
+        auto e = detail::binding_registry::get_effect(links.back().other);
+        assert(e);
+        e->remove_dead_source(*this);
     }
+    effects_changed();
 }
 
-void source::remove_dead_effect(effect* e) noexcept
+void source::effects_changed() noexcept
 {
-    assert(!is_iterating_bound_effects_);
-    bound_effects_.erase(e);
+    if(impl_)
+    {
+        detail::source_registry::set_has_effects(impl_.get(), has_bound_effect());
+    }
 }
 
-void source::request(void (detail::source_impl::*request)() const,
+void source::request(void (detail::source_impl::*request)(),
                      void (effect::*effect_request)(source &, const effect::callback &)) noexcept
 {
     assert(request && effect_request);
@@ -401,7 +563,7 @@ void source::request(void (detail::source_impl::*request)() const,
 
     if(is_valid())
     {
-        if (bound_effects_.empty())
+        if (!has_bound_effect())
         {
             (impl_.get()->*request)();
             return;
@@ -410,7 +572,8 @@ void source::request(void (detail::source_impl::*request)() const,
         ready_effects_count_ = 0;
         has_pending_request_ = true;
 
-        auto ready = [request, effects_count = bound_effects_.size()](source& src) {
+        auto effects_count = detail::binding_registry::get_effects(binding_).size();
+        auto ready = [request, effects_count](source& src) {
             // do not capture 'this'
             // because it could be called later and the source might have been moved
             ++src.ready_effects_count_;
@@ -437,8 +600,13 @@ void source::bound_effects_visitor(F&& func) noexcept(noexcept(std::forward<F>(f
 {
     assert(!is_iterating_bound_effects_);
     is_iterating_bound_effects_ = true;
-    for (auto& effect : bound_effects_)
+    // re-fetched on each step, the callback may bind sources
+    // which grows the registry and moves the lists around
+    for (size_t i = 0; i < detail::binding_registry::get_effects(binding_).size(); ++i)
     {
+        const auto& links = detail::binding_registry::get_effects(binding_);
+        auto effect = detail::binding_registry::get_effect(links[i].other);
+        assert(effect);
         std::forward<F>(func)(effect);
     }
     is_iterating_bound_effects_ = false;
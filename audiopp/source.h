@@ -1,10 +1,13 @@
 #pragma once
 
 #include "effects/effect.h"
+#include "filter.h"
+#include "playback_position.h"
 #include "sound.h"
 #include "types.h"
 
-#include <unordered_set>
+#include <functional>
+#include <vector>
 
 namespace audio
 {
@@ -13,6 +16,10 @@ namespace detail
 {
 class source_impl;
 class builtin_effect_impl;
+namespace source_registry
+{
+void update_effects(duration_t dt);
+}
 }
 
 //-----------------------------------------------------------------------------
@@ -22,6 +29,9 @@ class builtin_effect_impl;
 class source
 {
 public:
+    using stopped_callback = std::function<void(source&)>;
+    using buffer_completed_callback = std::function<void(source&, size_t)>;
+
     source();
     ~source();
     source(source&& rhs) noexcept;
@@ -35,12 +45,38 @@ public:
     //-----------------------------------------------------------------------------
     void bind(const sound& snd);
 
+    //-----------------------------------------------------------------------------
+    /// Specifies the shared sound to provide sound samples. The source does
+    /// not keep the sound alive.
+    //-----------------------------------------------------------------------------
+    void bind(const sound_handle& snd);
+
     //-----------------------------------------------------------------------------
     /// Unbinds the currently bound sound, making the source available
     /// to bind other sounds.
     //-----------------------------------------------------------------------------
     void unbind();
 
+    //-----------------------------------------------------------------------------
+    /// Queues the sound to play right after the bound one and those queued
+    /// before it, on the same voice without a gap. Once the bound sound is
+    /// played the queued one becomes the bound sound. The sounds must share
+    /// the format and be either all streamed or all static. Nothing moves on
+    /// while the source loops. Binding or unbinding clears the queue.
+    //-----------------------------------------------------------------------------
+    auto queue(const sound& snd) -> bool;
+    auto queue(const sound_handle& snd) -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Removes the queued sounds, the bound one keeps playing.
+    //-----------------------------------------------------------------------------
+    void clear_queue();
+
+    //-----------------------------------------------------------------------------
+    /// Gets how many sounds are queued after the bound one.
+    //-----------------------------------------------------------------------------
+    auto get_queued_sound_count() const -> size_t;
+
     //-----------------------------------------------------------------------------
     /// Checks whether this source has a sound binded to it.
     //-----------------------------------------------------------------------------
@@ -93,6 +129,17 @@ public:
     //-----------------------------------------------------------------------------
     void set_distance(float mind, float maxd) const;
 
+    //-----------------------------------------------------------------------------
+    /// Filters the direct path of the source, e.g. a lowpass to muffle it
+    /// when occluded. Cheap enough to be changed every frame.
+    //-----------------------------------------------------------------------------
+    void set_direct_filter(const filter& params) const;
+
+    //-----------------------------------------------------------------------------
+    /// Gets the filter of the direct path of the source.
+    //-----------------------------------------------------------------------------
+    auto get_direct_filter() const -> filter;
+
     //-----------------------------------------------------------------------------
     /// Sets the source buffer position, in seconds.
     //-----------------------------------------------------------------------------
@@ -103,6 +150,14 @@ public:
     //-----------------------------------------------------------------------------
     auto get_playback_position() const -> duration_t;
 
+    //-----------------------------------------------------------------------------
+    /// Gets the source buffer position exact to the sample, along with the
+    /// output latency and the device clock when OpenAL can tell them
+    /// (AL_SOFT_source_latency). Unlike get_playback_position it queries
+    /// OpenAL each time and does not lose precision on long sounds.
+    //-----------------------------------------------------------------------------
+    auto get_playback_position_precise() const -> playback_position;
+
     //-----------------------------------------------------------------------------
     /// Gets the source buffer length, in seconds.
     //-----------------------------------------------------------------------------
@@ -124,6 +179,16 @@ public:
     //-----------------------------------------------------------------------------
     void play();
 
+    //-----------------------------------------------------------------------------
+    /// Plays all the sources in the same mix, so that layers of music or
+    /// sound effects start sample accurately together. A delay schedules them
+    /// that far ahead on the device clock when OpenAL supports it, otherwise
+    /// they start right away. Sources with bound effects go through their
+    /// effects like play does, virtual ones start once they get a real voice
+    /// and ones whose static sound is still uploading once it is uploaded.
+    //-----------------------------------------------------------------------------
+    static void play_together(const std::vector<source*>& sources, duration_t delay = duration_t::zero());
+
     //-----------------------------------------------------------------------------
     /// Stop a Source.
     //-----------------------------------------------------------------------------
@@ -159,6 +224,12 @@ public:
     //-----------------------------------------------------------------------------
     auto is_muted() const -> bool;
 
+    //-----------------------------------------------------------------------------
+    /// Queries the playing state and the playback position from OpenAL now.
+    /// Otherwise they are refreshed once per update and on play/pause/stop.
+    //-----------------------------------------------------------------------------
+    void refresh_state() const;
+
     //-----------------------------------------------------------------------------
     /// Checks whether a source is currently playing.
     //-----------------------------------------------------------------------------
@@ -179,6 +250,37 @@ public:
     //-----------------------------------------------------------------------------
     auto is_looping() const -> bool;
 
+    //-----------------------------------------------------------------------------
+    /// Sets the priority used to hand out the real voices. Playing sources
+    /// with a higher priority get one first, ties go to the more audible ones.
+    //-----------------------------------------------------------------------------
+    void set_priority(int priority);
+
+    //-----------------------------------------------------------------------------
+    /// Gets the priority used to hand out the real voices.
+    //-----------------------------------------------------------------------------
+    auto get_priority() const -> int;
+
+    //-----------------------------------------------------------------------------
+    /// Checks whether a source is virtual at the moment. A virtual source keeps
+    /// its state and playback position but is not mixed.
+    //-----------------------------------------------------------------------------
+    auto is_virtual() const -> bool;
+
+    //-----------------------------------------------------------------------------
+    /// Sets the function called once the source stopped on its own, having
+    /// played the bound sound to its end. Calling stop does not invoke it.
+    /// Invoked by system::update, so there is no need to poll is_playing.
+    //-----------------------------------------------------------------------------
+    void on_stopped(stopped_callback callback);
+
+    //-----------------------------------------------------------------------------
+    /// Sets the function called with how many of the buffers queued on the
+    /// source finished playing. A whole sound counts as a single buffer, a
+    /// streamed one as many. Invoked by system::update.
+    //-----------------------------------------------------------------------------
+    void on_buffer_completed(buffer_completed_callback callback);
+
     //-----------------------------------------------------------------------------
     /// Checks whether a source is valid.
     //-----------------------------------------------------------------------------
@@ -202,10 +304,24 @@ public:
 
     //-----------------------------------------------------------------------------
     /// Updates the source's, e.g. the attached effects.
-    /// Updates the sound stream.
+    /// Updates the sound stream and refreshes the cached state.
+    /// system::update does the same for all sources at once.
     //-----------------------------------------------------------------------------
     void update(duration_t dt);
 
+    //-----------------------------------------------------------------------------
+    /// Sets how much audio should be queued ahead of the playback position when
+    /// the bound sound is streamed. Lower values mean less memory and latency,
+    /// but the source has to be updated more often to keep up.
+    //-----------------------------------------------------------------------------
+    void set_stream_lead_time(duration_t lead_time);
+
+    //-----------------------------------------------------------------------------
+    /// Gets how much audio is queued ahead of the playback position when
+    /// the bound sound is streamed.
+    //-----------------------------------------------------------------------------
+    auto get_stream_lead_time() const -> duration_t;
+
     //-----------------------------------------------------------------------------
     /// Gets the bound sound uid or 0 if none exists
     //-----------------------------------------------------------------------------
@@ -225,15 +341,17 @@ public:
 private:
     friend class detail::builtin_effect_impl;
     friend class effect;
+    friend class bus;
+    friend void detail::source_registry::update_effects(duration_t dt);
 
     void move(source&& rhs) noexcept;
+    void bind_sound(detail::sound_impl* snd);
+    void update_effects(duration_t dt);
 
-    void bind_effect(effect* effect) noexcept;
-    void unbind_effect(effect* effect) noexcept;
-    void change_effect_address(effect* from, effect* to) noexcept;
-    void remove_dead_effect(effect* e) noexcept;
+    void unbind_all_effects() noexcept;
+    void effects_changed() noexcept;
 
-    void request(void (detail::source_impl::*request)() const,
+    void request(void (detail::source_impl::*request)(),
                  void (effect::*effect_request)(source&, const effect::callback&)) noexcept;
 
     template<typename F>
@@ -242,7 +360,8 @@ private:
     bool has_pending_request_{};
     bool is_iterating_bound_effects_{};
     size_t ready_effects_count_{};
-    std::unordered_set<effect*> bound_effects_;
+    /// the bound effects are kept in the binding registry
+    detail::binding_handle binding_;
 
     /// pimpl idiom
     std::unique_ptr<detail::source_impl> impl_;
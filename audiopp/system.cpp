@@ -0,0 +1,71 @@
+#include "system.h"
+#include "impl/bus_impl.h"
+#include "impl/playlist_impl.h"
+#include "impl/sound_impl.h"
+#include "impl/source_events.h"
+#include "impl/source_registry.h"
+#include "impl/voice_pool.h"
+
+#include <chrono>
+
+namespace audio
+{
+namespace system
+{
+
+namespace
+{
+using clock = std::chrono::steady_clock;
+
+update_timings timings;
+} // namespace
+
+void update(duration_t dt)
+{
+    auto start = clock::now();
+
+    // sounds released on other threads are destroyed here
+    detail::sound_impl::release_pending();
+    auto released = clock::now();
+
+    // the voices which stopped meanwhile are known before they are reassigned
+    detail::source_events::poll();
+    auto polled = clock::now();
+
+    // the voices are ranked by their volumes scaled by the buses
+    detail::bus_impl::flush_dirty();
+    auto flushed = clock::now();
+
+    detail::source_registry::update_streams();
+
+    // after the streams, which move the sources on to their queued sounds
+    detail::playlist_impl::update_all(dt);
+    auto streamed = clock::now();
+
+    // virtual voices catch up with the clock on their own
+    detail::voice_pool::update(dt);
+    auto voiced = clock::now();
+
+    detail::source_registry::update_effects(dt);
+    auto effected = clock::now();
+
+    // last, since the callbacks may do anything with the sources
+    detail::source_events::dispatch();
+    auto end = clock::now();
+
+    timings.release = released - start;
+    timings.streams = streamed - flushed;
+    timings.voices = (flushed - polled) + (voiced - streamed);
+    timings.effects = effected - voiced;
+    timings.events = (polled - released) + (end - effected);
+    timings.total = end - start;
+    timings.sources = detail::source_registry::size();
+}
+
+auto get_update_timings() -> update_timings
+{
+    return timings;
+}
+
+} // namespace system
+} // namespace audio
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "types.h"
+
+#include <cstdint>
+
+namespace audio
+{
+namespace system
+{
+
+struct update_timings
+{
+    /// sounds released on other threads destroyed
+    duration_t release{};
+
+    /// uploads and stream refills of the sources with a sound bound
+    duration_t streams{};
+
+    /// bus changes, state polling and real voice assignment
+    duration_t voices{};
+
+    /// updates of the effects bound to the sources
+    duration_t effects{};
+
+    /// source events applied and source callbacks invoked
+    duration_t events{};
+
+    /// the whole update
+    duration_t total{};
+
+    /// sources alive during the update
+    std::uint64_t sources{};
+};
+
+//-----------------------------------------------------------------------------
+/// Updates every live source at once. The changes of the buses are applied,
+/// streams are refilled, the playing state is polled unless the mixer reports
+/// it, the real voices are reassigned (see update_voices), the bound effects
+/// are updated and the callbacks of the sources are invoked. Replaces calling
+/// source::update on each source, call once per frame from the thread which
+/// created the device.
+//-----------------------------------------------------------------------------
+void update(duration_t dt);
+
+//-----------------------------------------------------------------------------
+/// Gets how long the phases of the last update took.
+//-----------------------------------------------------------------------------
+auto get_update_timings() -> update_timings;
+
+} // namespace system
+} // namespace audio
@@ -0,0 +1,36 @@
+#include "voices.h"
+#include "impl/voice_pool.h"
+
+namespace audio
+{
+
+void set_max_voices(std::size_t count)
+{
+    detail::voice_pool::set_max_voices(count);
+}
+
+auto get_max_voices() -> std::size_t
+{
+    return detail::voice_pool::get_max_voices();
+}
+
+void set_voice_grid_cell_size(float size)
+{
+    detail::voice_pool::set_cell_size(size);
+}
+
+auto get_voice_grid_cell_size() -> float
+{
+    return detail::voice_pool::get_cell_size();
+}
+
+void update_voices(duration_t dt)
+{
+    detail::voice_pool::update(dt);
+}
+
+auto get_voice_stats() -> voice_stats
+{
+    return detail::voice_pool::get_stats();
+}
+} // namespace audio
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "types.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace audio
+{
+
+struct voice_stats
+{
+    /// how many real voices may be used at once
+    std::uint64_t max_voices{};
+
+    /// sources alive
+    std::uint64_t logical{};
+
+    /// sources which own a real voice and are being mixed
+    std::uint64_t real{};
+
+    /// sources without a real voice, only tracking their playback position
+    std::uint64_t virtualized{};
+
+    /// times a virtual source got a real voice
+    std::uint64_t promotions{};
+
+    /// times a source gave its real voice away
+    std::uint64_t demotions{};
+
+    /// playing sources near enough to the listener
+    /// to be tested for audibility in the last update
+    std::uint64_t tested{};
+};
+
+//-----------------------------------------------------------------------------
+/// Sets how many real OpenAL sources may be mixed at once. Sources over the
+/// limit are virtual, they keep their state and playback position without
+/// being mixed. 0 means as many as the device supports.
+//-----------------------------------------------------------------------------
+void set_max_voices(std::size_t count);
+
+//-----------------------------------------------------------------------------
+/// Gets how many real OpenAL sources may be mixed at once.
+//-----------------------------------------------------------------------------
+auto get_max_voices() -> std::size_t;
+
+//-----------------------------------------------------------------------------
+/// Sets the size of the cells of the uniform grid the sources are kept in.
+/// Each update only tests the sources in the cells within reach of the
+/// listener, where the reach is the largest distance at which a source can
+/// still be heard (see source::set_distance and source::set_volume_rolloff).
+/// Sources which can be heard from anywhere are always tested. Cells around
+/// the typical reach of the sources work best.
+//-----------------------------------------------------------------------------
+void set_voice_grid_cell_size(float size);
+
+//-----------------------------------------------------------------------------
+/// Gets the size of the cells of the uniform grid the sources are kept in.
+//-----------------------------------------------------------------------------
+auto get_voice_grid_cell_size() -> float;
+
+//-----------------------------------------------------------------------------
+/// Advances the virtual sources and hands the real voices to the playing
+/// sources with the highest priority and then audibility (volume times
+/// distance attenuation). Inaudible sources are virtualized and resume
+/// from where they would be once they get a voice back. Call once per frame.
+//-----------------------------------------------------------------------------
+void update_voices(duration_t dt);
+
+//-----------------------------------------------------------------------------
+/// Gets the counters of the voice pool.
+//-----------------------------------------------------------------------------
+auto get_voice_stats() -> voice_stats;
+} // namespace audio
@@ -0,0 +1,95 @@
+#include <audiopp/library.h>
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+// binds anything, only the bookkeeping of the bindings is measured
+struct null_effect : audio::effect
+{
+    auto bind_impl(audio::source&) noexcept -> bool override
+    {
+        return true;
+    }
+    void unbind_impl(audio::source&) noexcept override
+    {
+    }
+    void unbind_all_impl() noexcept override
+    {
+    }
+};
+
+auto create_device() -> std::shared_ptr<void>
+{
+    // headless when possible
+    if(audio::loopback_device::is_supported())
+    {
+        return std::make_shared<audio::loopback_device>();
+    }
+    return std::make_shared<audio::device>();
+}
+} // namespace
+
+int main(int argc, char* argv[]) try
+{
+    size_t sources_count = argc > 1 ? size_t(std::stoul(argv[1])) : 4000;
+    size_t effects_count = 8;
+    size_t rounds = 20;
+
+    auto device = create_device();
+
+    std::vector<audio::source> sources(sources_count);
+    std::vector<null_effect> effects(effects_count);
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t round = 0; round < rounds; ++round)
+    {
+        for(auto& e : effects)
+        {
+            for(auto& src : sources)
+            {
+                e.bind(src);
+            }
+        }
+
+        // move every bound source and effect around
+        for(size_t i = 0; i + 1 < sources.size(); i += 2)
+        {
+            auto tmp = std::move(sources[i]);
+            sources[i] = std::move(sources[i + 1]);
+            sources[i + 1] = std::move(tmp);
+        }
+
+        std::vector<null_effect> moved(effects_count);
+        for(size_t i = 0; i < effects.size(); ++i)
+        {
+            moved[i] = std::move(effects[i]);
+            effects[i] = std::move(moved[i]);
+        }
+
+        for(auto& e : effects)
+        {
+            for(auto& src : sources)
+            {
+                e.unbind(src);
+            }
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    auto operations = double(rounds * sources_count * effects_count * 2);
+    std::cout << "bind/move/unbind churn over " << sources_count << " sources and " << effects_count
+              << " effects, " << rounds << " rounds: " << elapsed.count() << "ms ("
+              << elapsed.count() * 1000000.0 / operations << "ns per bind/unbind)" << std::endl;
+
+    return 0;
+}
+catch(const std::exception& e)
+{
+    std::cout << e.what() << std::endl;
+    return 1;
+}
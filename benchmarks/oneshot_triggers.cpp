@@ -0,0 +1,87 @@
+#include <audiopp/library.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+auto create_click() -> audio::sound_data
+{
+    audio::sound_data data;
+    data.info.id = "click";
+    data.info.sample_rate = 44100;
+    data.info.bits_per_sample = 16;
+    data.info.channels = 1;
+    data.info.frames = data.info.sample_rate * 15 / 100;
+    data.info.duration = audio::duration_t(double(data.info.frames) / data.info.sample_rate);
+
+    // a decaying square wave
+    std::vector<std::int16_t> samples(data.info.frames);
+    for(size_t i = 0; i < samples.size(); ++i)
+    {
+        auto amplitude = 8000.0 * double(samples.size() - i) / double(samples.size());
+        samples[i] = std::int16_t((i / 50) % 2 == 0 ? amplitude : -amplitude);
+    }
+
+    auto bytes = reinterpret_cast<const std::uint8_t*>(samples.data());
+    data.data.assign(bytes, bytes + samples.size() * sizeof(std::int16_t));
+    return data;
+}
+} // namespace
+
+int main(int argc, char* argv[]) try
+{
+    if(!audio::loopback_device::is_supported())
+    {
+        std::cout << "ALC_SOFT_loopback is not supported" << std::endl;
+        return 1;
+    }
+
+    size_t triggers_per_second = argc > 1 ? size_t(std::stoul(argv[1])) : 3000;
+    const size_t fps = 60;
+    const size_t seconds = 20;
+
+    audio::loopback_device device;
+    const auto rate = device.get_format().sample_rate;
+    const size_t frames_per_update = rate / fps;
+    std::vector<std::uint8_t> mix(frames_per_update * device.get_frame_size());
+
+    audio::sound click(create_click());
+    audio::set_max_oneshots(512);
+
+    const auto per_update = triggers_per_second / fps;
+    auto start = std::chrono::steady_clock::now();
+    for(size_t update = 0; update < fps * seconds; ++update)
+    {
+        for(size_t i = 0; i < per_update; ++i)
+        {
+            // spread around the listener, so that some of them go virtual
+            audio::oneshot_params params;
+            params.position = {{float(i % 16) * 4.0f, 0.0f, float(update % 8)}};
+            params.max_distance = 100.0f;
+            audio::play_oneshot(click, params);
+        }
+
+        device.render(frames_per_update, mix.data());
+        audio::system::update(audio::duration_t(1.0 / fps));
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+
+    audio::stop_oneshots();
+
+    auto stats = audio::get_oneshot_stats();
+    std::cout << stats.played << " one-shots over " << seconds << "s of audio at " << per_update * fps
+              << " triggers/s, mixed in " << elapsed.count() << "s (" << double(seconds) / elapsed.count()
+              << "x realtime). Pooled " << stats.pooled << ", dropped " << stats.dropped << std::endl;
+
+    return stats.dropped == 0 && elapsed.count() < double(seconds) ? 0 : 1;
+}
+catch(const std::exception& e)
+{
+    std::cout << e.what() << std::endl;
+    return 1;
+}
@@ -1,11 +1,18 @@
+#include <audiopp/impl/binding_registry.h>
+#include <audiopp/impl/chunk_list.h>
+#include <audiopp/impl/spsc_queue.h>
 #include <audiopp/library.h>
+#include <audiopp/loaders/decoder_cursor.h>
 #include <audiopp/loaders/loader.h>
 #include <suitepp/suite.hpp>
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <functional>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string>
 #include <thread>
 
@@ -22,6 +29,54 @@ void add_expected_info(std::vector<audio::sound_info>& infos, const std::string&
 	infos.emplace_back(expected);
 }
 
+// a steady sine, never silent for more than a sample
+audio::sound_data create_tone(double seconds)
+{
+	audio::sound_data data;
+	data.info.id = "tone";
+	data.info.sample_rate = 44100;
+	data.info.bits_per_sample = 16;
+	data.info.channels = 1;
+	data.info.frames = uint64_t(seconds * data.info.sample_rate);
+	data.info.duration = audio::duration_t(double(data.info.frames) / data.info.sample_rate);
+
+	std::vector<int16_t> samples(data.info.frames);
+	for(size_t i = 0; i < samples.size(); ++i)
+	{
+		samples[i] = int16_t(8000.0 * std::sin(0.1 + 2.0 * 3.14159265 * 440.0 * double(i) / data.info.sample_rate));
+	}
+
+	auto bytes = reinterpret_cast<const uint8_t*>(samples.data());
+	data.data.assign(bytes, bytes + samples.size() * sizeof(int16_t));
+	return data;
+}
+
+// binds anything and counts the updates it gets
+struct counting_effect : audio::effect
+{
+	auto bind_impl(audio::source&) noexcept -> bool override
+	{
+		return true;
+	}
+	void unbind_impl(audio::source&) noexcept override
+	{
+	}
+	void unbind_all_impl() noexcept override
+	{
+	}
+	void update(audio::source& src, const audio::duration_t&) noexcept override
+	{
+		updated.push_back(&src);
+		if(on_update)
+		{
+			on_update(src);
+		}
+	}
+
+	std::vector<audio::source*> updated;
+	std::function<void(audio::source&)> on_update;
+};
+
 int main() try
 {
 	audio::set_info_logger([](const std::string& msg) { std::cout << msg << std::endl; });
@@ -117,6 +172,421 @@ int main() try
 		};
 	}
 
+	const std::vector<std::string> cursor_files = {
+		"wav/pcm1644s.wav", "wav/pcm2422m.wav", "wav/ulaw11m.wav", "wav/ima44s.wav", "wav/ms22m.wav",
+		"flac/pcm1644s.flac", "flac/pcm2408m.flac", "ogg/pcm1644s.ogg", "ogg/pcm0822m.ogg",
+		"mp3/pcm1644s.mp3", "mp3/pcm1622m.mp3", "mp3/pcm0808m.mp3"};
+
+	for(const auto& file : cursor_files)
+	{
+		TEST_CASE("decoder cursor seeking " + file)
+		{
+			std::string err;
+			audio::sound_data decoded;
+			audio::encoded_sound_data encoded;
+			EXPECT(audio::load_from_file(data_path + file, decoded, err));
+			EXPECT(audio::load_encoded_from_file(data_path + file, encoded, err));
+			EXPECT(encoded.info.frames == decoded.info.frames);
+
+			auto cursor =
+				audio::detail::create_decoder_cursor(encoded.data.data(), encoded.data.size(), encoded.codec, encoded.info);
+			EXPECT(cursor != nullptr);
+			if(!cursor)
+			{
+				return;
+			}
+
+			// back and forth, the way sources seek and loop
+			const size_t frames = size_t(decoded.info.frames);
+			const size_t frame_size = decoded.info.channels * decoded.info.bits_per_sample / 8;
+			for(auto frame : {frames / 2, size_t(0), frames / 3, size_t(1), frames - 100, frames / 5})
+			{
+				cursor->seek(frame * frame_size);
+				EXPECT(cursor->tell() == frame * frame_size);
+
+				auto expected_size = std::min<size_t>(1024, frames - frame) * frame_size;
+				std::vector<uint8_t> read;
+				while(read.size() < expected_size)
+				{
+					const uint8_t* data = nullptr;
+					auto size = cursor->read(expected_size - read.size(), data);
+					if(size == 0)
+					{
+						break;
+					}
+					read.insert(read.end(), data, data + size);
+				}
+
+				// the same pcm as decoding it all at once
+				auto expected = decoded.data.begin() + std::ptrdiff_t(frame * frame_size);
+				EXPECT(read.size() == expected_size);
+				EXPECT(std::equal(read.begin(), read.end(), expected));
+			}
+		};
+	}
+
+	TEST_CASE("chunk list append, read across blocks and release")
+	{
+		using byte_array_t = audio::detail::chunk_list::byte_array_t;
+		const size_t block_size = audio::detail::chunk_list::block_size;
+
+		// small chunks get packed, big ones adopted
+		audio::detail::chunk_list chunks;
+		byte_array_t expected;
+		for(size_t i = 0; i < 40; ++i)
+		{
+			byte_array_t chunk(i % 3 == 0 ? block_size + 100 : 5000 + i, uint8_t(i));
+			expected.insert(expected.end(), chunk.begin(), chunk.end());
+			chunks.append(std::move(chunk));
+		}
+		EXPECT(chunks.size() == expected.size());
+		EXPECT(chunks.begin_offset() == 0 && chunks.end_offset() == expected.size());
+
+		byte_array_t scratch;
+		for(size_t offset = 0; offset + 3000 < expected.size(); offset += 4093)
+		{
+			auto data = chunks.data(offset, 3000, scratch);
+			EXPECT(data != nullptr);
+			EXPECT(std::equal(data, data + 3000, expected.begin() + std::ptrdiff_t(offset)));
+		}
+
+		// offsets stay absolute once the front is gone
+		const size_t released = expected.size() / 2;
+		chunks.release_until(released);
+		EXPECT(chunks.begin_offset() <= released && chunks.begin_offset() > 0);
+		EXPECT(chunks.end_offset() == expected.size());
+		auto data = chunks.data(released, 1000, scratch);
+		EXPECT(std::equal(data, data + 1000, expected.begin() + std::ptrdiff_t(released)));
+
+		// a moved from list is left empty and usable
+		audio::detail::chunk_list moved(std::move(chunks));
+		EXPECT(chunks.empty() && chunks.size() == 0);
+		EXPECT(moved.end_offset() == expected.size());
+		chunks.append(byte_array_t(10, 1));
+		EXPECT(chunks.size() == 10);
+
+		const size_t begin = moved.begin_offset();
+		auto all = moved.take();
+		EXPECT(moved.empty());
+		EXPECT(all.size() == expected.size() - begin);
+		EXPECT(std::equal(all.begin(), all.end(), expected.end() - std::ptrdiff_t(all.size())));
+	};
+
+	TEST_CASE("spsc queue keeps order and fails when full")
+	{
+		audio::detail::spsc_queue<std::unique_ptr<int>> queue(5);
+		EXPECT(queue.capacity() == 8);
+		EXPECT(queue.empty());
+
+		std::unique_ptr<int> value;
+		EXPECT(!queue.try_pop(value));
+
+		// wrap around a few times
+		int pushed = 0;
+		int popped = 0;
+		for(int round = 0; round < 5; ++round)
+		{
+			while(queue.try_push(std::make_unique<int>(pushed)))
+			{
+				++pushed;
+			}
+			EXPECT(pushed - popped == int(queue.capacity()));
+
+			for(int i = 0; i < 3 && queue.try_pop(value); ++i)
+			{
+				EXPECT(value && *value == popped);
+				++popped;
+			}
+		}
+		while(queue.try_pop(value))
+		{
+			EXPECT(value && *value == popped);
+			++popped;
+		}
+		EXPECT(popped == pushed && queue.empty());
+
+		// one thread producing while the other consumes
+		audio::detail::spsc_queue<int> ints(64);
+		const int count = 100000;
+		std::thread producer([&]() {
+			for(int i = 0; i < count;)
+			{
+				int v = i;
+				if(ints.try_push(std::move(v)))
+				{
+					++i;
+				}
+			}
+		});
+		int next = 0;
+		bool in_order = true;
+		while(next < count)
+		{
+			int v = 0;
+			if(ints.try_pop(v))
+			{
+				in_order = in_order && v == next;
+				++next;
+			}
+		}
+		producer.join();
+		EXPECT(in_order && ints.empty());
+	};
+
+	if(audio::loopback_device::is_supported())
+	{
+		audio::loopback_device device;
+		const auto frame_size = device.get_frame_size();
+		const auto rate = device.get_format().sample_rate;
+
+		// mixes in blocks, updating in between like a frame loop would
+		auto render = [&](audio::source& source, size_t max_frames) {
+			const size_t block = 1024;
+			std::vector<int16_t> out(block * frame_size / sizeof(int16_t));
+			std::vector<int16_t> rendered;
+			size_t frames = 0;
+			while((source.is_playing() || source.is_waiting()) && frames < max_frames)
+			{
+				device.render(block, out.data());
+				rendered.insert(rendered.end(), out.begin(), out.end());
+				frames += block;
+				audio::system::update(audio::duration_t(double(block) / rate));
+			}
+			return rendered;
+		};
+
+		auto is_silent = [](const std::vector<int16_t>& samples) {
+			return std::all_of(samples.begin(), samples.end(), [](int16_t s) { return s == 0; });
+		};
+
+		for(auto& data : loaded_sounds)
+		{
+			TEST_CASE("loopback playback " + data.info.id)
+			{
+				auto duration = data.info.duration;
+				audio::sound sound(std::move(data));
+
+				audio::source source;
+				source.bind(sound);
+				source.play();
+
+				auto max_frames = size_t((duration.count() + 1.0) * rate);
+				auto rendered = render(source, max_frames);
+
+				EXPECT(!source.is_playing());
+				EXPECT(!is_silent(rendered));
+			};
+		}
+
+		const std::string file = data_path + "wav/pcm1644m.wav";
+
+		TEST_CASE("loopback render is deterministic")
+		{
+			std::vector<std::vector<int16_t>> renders;
+			for(int i = 0; i < 2; ++i)
+			{
+				std::string err;
+				audio::sound_data data;
+				EXPECT(audio::load_from_file(file, data, err));
+
+				audio::sound sound(std::move(data));
+				audio::source source;
+				source.bind(sound);
+				source.play();
+				renders.emplace_back(render(source, size_t(rate)));
+			}
+
+			EXPECT(renders[0] == renders[1]);
+		};
+
+		// longest run of silent frames within [begin, end)
+		auto get_longest_silence = [&](const std::vector<int16_t>& samples, size_t begin, size_t end) {
+			const size_t channels = frame_size / sizeof(int16_t);
+			size_t longest = 0;
+			size_t run = 0;
+			for(size_t frame = begin; frame < end && (frame + 1) * channels <= samples.size(); ++frame)
+			{
+				auto first = samples.begin() + std::ptrdiff_t(frame * channels);
+				bool silent = std::all_of(first, first + std::ptrdiff_t(channels), [](int16_t s) { return s == 0; });
+				run = silent ? run + 1 : 0;
+				longest = std::max(longest, run);
+			}
+			return longest;
+		};
+
+		for(bool stream : {false, true})
+		{
+			TEST_CASE(std::string("loopback gapless queue ") + (stream ? "streamed" : "static"))
+			{
+				auto first = create_tone(1.0);
+				auto first_frames = size_t(first.info.frames);
+				auto duration = first.info.duration * 2.0;
+
+				audio::sound a(std::move(first), stream);
+				audio::sound b(create_tone(1.0), stream);
+
+				audio::source source;
+				source.bind(a);
+				EXPECT(source.queue(b));
+
+				// uploaded before playing, so that the tone starts right away
+				for(int i = 0; i < 10; ++i)
+				{
+					audio::system::update(audio::duration_t::zero());
+				}
+				source.play();
+
+				auto rendered = render(source, size_t((duration.count() + 1.0) * rate));
+				EXPECT(source.get_bound_sound_uid() == b.uid());
+
+				// the tone never falls silent where the first sound ends.
+				// Silent only before starting, so the longest silence is the lead in.
+				auto start = get_longest_silence(rendered, 0, rate / 4);
+				auto boundary = start + first_frames;
+				EXPECT(get_longest_silence(rendered, boundary - 2048, boundary + 2048) < 16);
+
+				// and both played back to back, within a block of the sum
+				auto frames = rendered.size() * sizeof(int16_t) / frame_size;
+				EXPECT(std::abs(double(frames) / rate - duration.count()) < 0.05);
+			};
+		}
+
+		TEST_CASE("binding registry handles go stale")
+		{
+			namespace registry = audio::detail::binding_registry;
+			audio::source src;
+			counting_effect effect;
+
+			audio::detail::binding_handle src_handle;
+			audio::detail::binding_handle effect_handle;
+			registry::bind(src_handle, &src, effect_handle, &effect);
+			EXPECT(registry::is_bound(src_handle, effect_handle));
+			EXPECT(registry::get_source(src_handle) == &src);
+
+			// the slot gets reused by the next one, with a new generation
+			auto stale = src_handle;
+			registry::unbind(src_handle, effect_handle);
+			registry::release_source(src_handle);
+			EXPECT(registry::get_source(stale) == nullptr);
+
+			audio::source other;
+			audio::detail::binding_handle other_handle;
+			registry::bind(other_handle, &other, effect_handle, &effect);
+			EXPECT(other_handle.index == stale.index && other_handle.generation != stale.generation);
+			EXPECT(registry::get_source(stale) == nullptr);
+			EXPECT(!registry::is_bound(stale, effect_handle));
+			EXPECT(registry::get_effects(stale).empty());
+			registry::unbind(stale, effect_handle);
+			EXPECT(registry::is_bound(other_handle, effect_handle));
+
+			registry::unbind(other_handle, effect_handle);
+			registry::release_source(other_handle);
+			registry::release_effect(effect_handle);
+		};
+
+		TEST_CASE("bindings follow moved sources and effects")
+		{
+			counting_effect a;
+			counting_effect b;
+			{
+				audio::source first;
+				audio::source second;
+				EXPECT(a.bind(first) && a.bind(second) && b.bind(first));
+
+				// the effects reach the sources at their new address
+				audio::source moved = std::move(first);
+				EXPECT(a.has_bound(moved) && b.has_bound(moved) && !a.has_bound(first));
+				moved.update(audio::duration_t(0.01));
+				EXPECT(a.updated.size() == 1 && a.updated.back() == &moved);
+				EXPECT(b.updated.size() == 1 && b.updated.back() == &moved);
+
+				counting_effect c = std::move(a);
+				EXPECT(!a.has_bound_source());
+				EXPECT(c.has_bound(moved) && c.has_bound(second) && moved.has_bound(c));
+
+				c.unbind(second);
+				EXPECT(!c.has_bound(second) && !second.has_bound_effect() && c.has_bound(moved));
+
+				second = std::move(moved);
+				EXPECT(c.has_bound(second) && b.has_bound(second));
+				b.unbind_all();
+				EXPECT(!b.has_bound_source() && !second.has_bound(b) && second.has_bound(c));
+
+				a = std::move(c);
+				EXPECT(a.has_bound(second));
+			}
+
+			// destroyed sources unbind themselves
+			EXPECT(!a.has_bound_source() && !b.has_bound_source());
+		};
+
+		TEST_CASE("unbinding swaps the last binding into the freed position")
+		{
+			counting_effect effect;
+			std::vector<audio::source> sources(8);
+			for(auto& src : sources)
+			{
+				EXPECT(effect.bind(src));
+			}
+
+			// from the middle, then the rest from both sides
+			effect.unbind(sources[3]);
+			EXPECT(!effect.has_bound(sources[3]));
+			for(size_t i = 0; i < sources.size(); ++i)
+			{
+				EXPECT(effect.has_bound(sources[i]) == (i != 3));
+				EXPECT(sources[i].has_bound(effect) == (i != 3));
+			}
+			effect.unbind(sources[0]);
+			effect.unbind(sources[7]);
+			effect.unbind(sources[5]);
+			EXPECT(effect.has_bound(sources[1]) && effect.has_bound(sources[2]) && effect.has_bound(sources[4]) &&
+				   effect.has_bound(sources[6]));
+
+			// an effect destroyed while still bound
+			{
+				counting_effect temporary;
+				EXPECT(temporary.bind(sources[2]) && temporary.bind(sources[4]));
+			}
+			EXPECT(sources[2].has_bound(effect) && sources[4].has_bound(effect));
+
+			effect.unbind_all();
+			for(auto& src : sources)
+			{
+				EXPECT(!src.has_bound_effect());
+			}
+		};
+
+		TEST_CASE("bindings made while visiting the effects of a source")
+		{
+			audio::source src;
+			std::vector<std::unique_ptr<audio::source>> spawned;
+			counting_effect other;
+			counting_effect first;
+			counting_effect second;
+
+			// grows the registry while the effects of the source are visited
+			first.on_update = [&](audio::source&) {
+				for(int i = 0; i < 64; ++i)
+				{
+					spawned.emplace_back(std::make_unique<audio::source>());
+					other.bind(*spawned.back());
+				}
+			};
+			EXPECT(first.bind(src) && second.bind(src));
+
+			src.update(audio::duration_t(0.01));
+			src.update(audio::duration_t(0.01));
+			EXPECT(first.updated.size() == 2 && second.updated.size() == 2);
+			EXPECT(src.has_bound(first) && src.has_bound(second));
+
+			spawned.erase(spawned.begin(), spawned.begin() + 100);
+			EXPECT(other.has_bound(*spawned.front()) && other.has_bound(*spawned.back()));
+			spawned.clear();
+			EXPECT(!other.has_bound_source());
+		};
+	}
+
     auto playback_devices = audio::device::enumerate_playback_devices();
     if(playback_devices.empty())
     {